@@ -21,6 +21,7 @@
 #define ADC_H_
 // ****** Includes ******
 #include "oScale.h"
+#include <util/atomic.h>
 
 // ****** Defines ******
 // IOs
@@ -30,11 +31,50 @@
 #define ADC_CS      PD5
 #define ADC_DATA    PD6
 #define ADC_CLK     PD7
+#define ADC_SAMPLE_BITS 15  // Clocks of one sample: 3 for the sampling and the null bit, 12 data bits
 
+// Sampling in the timer interrupt
+#ifndef ADC_TASK
+#define ADC_TASK        TASK1   // Task group which filters the samples, it is started by every full block
+#endif
+#define ADC_SAMPLE_TICKS    SYS_TICKS(TASK1_ms * 1000UL) // SysTicks between two filtered samples
+#define ADC_SAMPLE_TCNT     100 // TCNT0 of the compare match which samples, in the middle of the SysTick
+#define ADC_SAMPLE_us       80  // Upper bound of the time to read one sample in the interrupt
+
+// Oversampling, ADC_OSR samples are decimated to one filtered sample
+#ifndef ADC_OSR
+#define ADC_OSR         10      // Oversampling ratio, has to divide ADC_SAMPLE_TICKS: 10 => 1 kHz
+#endif
+#define ADC_OSR_TICKS   (ADC_SAMPLE_TICKS / ADC_OSR) // SysTicks between two samples of the ADC
+#define ADC_OSR_BITS    2       // Extra bits of the filtered value, the PT1 filters 12 + ADC_OSR_BITS bits
+
+// Double buffer, the interrupt fills one block while the task filters the other one
+#ifndef ADC_BLOCK
+#define ADC_BLOCK       ADC_OSR // Samples of one block, a multiple of ADC_OSR
+#endif
+
+typedef struct  // Block of samples which is filtered in one run of the task
+{
+    unsigned int sample[ADC_BLOCK]; // The raw samples in the order they were read
+    unsigned int stamp;             // The SysTick of the last sample
+} adcBlock_t;
+
+typedef struct  // Timing of the samples in the interrupt
+{
+    unsigned char min;      // Earliest TCNT0 when a sample started
+    unsigned char max;      // Latest TCNT0 when a sample started
+    unsigned char overrun;  // Blocks which were dropped, the task did not filter the previous block in time
+} adcTiming_t;
 
 // ****** Functions ******
 void            Task_ADC                (void);
 void            adc_InitTask            (void);
+void            adc_TickISR             (void);
 unsigned int    adc_Sample              (void);
 unsigned int    adc_GetValue            (void);
+unsigned int    adc_GetValueFine        (void);
+unsigned int    adc_GetStamp            (void);
+unsigned char   adc_GetJitter           (void);
+adcTiming_t*    adc_GetTiming           (void);
+void            adc_ResetTiming         (void);
 #endif
\ No newline at end of file
@@ -22,6 +22,8 @@
 
 // ****** Includes ******
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <scheduler.h>
 #include <sarb.h>
 
@@ -31,6 +33,12 @@ typedef struct   // Content data for display
     unsigned char x;
     unsigned char y;
     char* string;
+    unsigned char pattern;  // The byte which fills a rectangle
+    unsigned char column;   // The current RAM column address of the display
+    unsigned char page;     // The current RAM page address of the display
+    const __flash unsigned char* glyph; // The next glyph column which is streamed
+    unsigned int stamp;     // The time stamp of the active command
+    unsigned char stamped;  // The active command has a time stamp
 } dispDat_t;
 
 // ****** Defines ******
@@ -77,6 +85,89 @@ typedef struct   // Content data for display
 #define DISP_CMD_WRITE_DIGIT    6 // Write a digit in the digit font to the display
 #define DISP_CMD_WRITE_STRING   7 // Write a string to the display in the character font.
 #define DISP_CMD_WRITE_NUMBER   8 // Write a string with digits to the display in the digit font.
+#define DISP_CMD_BLIT_STRING    9 // Stream a string in the character font with one address per page.
+#define DISP_CMD_BLIT_NUMBER    10 // Stream a string in the digit font with one address per page.
+#define DISP_CMD_PLOT_COLUMN    11 // Plot one sample column of a strip chart and clear the column in front of it.
+#define DISP_CMD_FILL_RECT      12 // Fill a rectangle with a constant byte, streamed with one address per page.
+
+// Strip chart
+#define DISP_PLOT_BLANK     0x0F    // Pixel range which clears the plotted column
+
+// Task group of the display task, it only runs when a command is queued or active
+#ifndef DISP_TASK
+#define DISP_TASK           TASK0
+#endif
+
+// SPI transmit engine
+#ifndef DISP_SPI_ISR
+#define DISP_SPI_ISR        1   // Send the bytes from a ring buffer in the SPI interrupt
+#endif
+#define DISP_TX_SIZE        16  // Size of the transmit ring buffer, HAS to be a power of 2!
+#define DISP_STEPS_PER_TICK 16  // Maximum number of command steps per call of the display task
+
+// Burst mode without the SPI interrupt
+#define DISP_BURST_STEPS    32  // Maximum number of command steps per call of the display task
+#define DISP_BURST_TCNT     120 // Stop the burst when TCNT0 reaches this count (1 count = 1 us)
+
+#if (DISP_TX_SIZE & (DISP_TX_SIZE - 1)) || (DISP_TX_SIZE > 128)
+#error "DISP_TX_SIZE has to be a power of 2 and not greater than 128!"
+#endif
+
+// Shadow of the display RAM for the region with the changing values
+#define DISP_SHADOW_PAGE    4   // First page of the shadow region
+#define DISP_SHADOW_PAGES   2   // Number of pages in the shadow region, 0 disables the shadow
+
+// Latency of the time stamped commands
+#ifndef DISP_LATENCY
+#define DISP_LATENCY        1   // Record the time from the stamp until a command is finished
+#endif
+
+// Command queue
+#define DISP_QUEUE_SIZE     8   // Number of commands which can be queued, HAS to be a power of 2!
+
+#if (DISP_QUEUE_SIZE & (DISP_QUEUE_SIZE - 1)) || (DISP_QUEUE_SIZE > 128)
+#error "DISP_QUEUE_SIZE has to be a power of 2 and not greater than 128!"
+#endif
+
+typedef struct  // One queued display command with its data
+{
+    unsigned char command;
+    unsigned char argument[NUMBER_OF_ARGUMENTS];
+    unsigned char x;
+    unsigned char y;
+    char* string;
+    unsigned char pattern;  // The byte which fills a rectangle
+    unsigned int stamp;     // The time stamp of the data
+    unsigned char stamped;  // The command has a time stamp
+} dispCall_t;
+
+typedef struct  // FIFO of the display commands
+{
+    dispCall_t call[DISP_QUEUE_SIZE];
+    unsigned char head;                 // Write index
+    unsigned char tail;                 // Read index
+    unsigned char x;                    // Cursor for the next queued command
+    unsigned char y;                    // Line for the next queued command
+    unsigned int stamp;                 // Time stamp for the next queued command
+    unsigned char stamped;              // The next queued command gets the time stamp
+} dispQueue_t;
+
+typedef struct  // Statistics of the latency in SysTicks
+{
+    unsigned int min;
+    unsigned int max;
+    unsigned long sum;
+    unsigned int count;
+} dispLatency_t;
+
+typedef struct  // Transmit ring buffer for the SPI interrupt
+{
+    unsigned char data[DISP_TX_SIZE];   // The bytes to send
+    unsigned char a0[DISP_TX_SIZE];     // The state of the A0 pin for every byte
+    volatile unsigned char head;        // Write index, only changed by the task
+    volatile unsigned char tail;        // Read index, only changed by the ISR
+    volatile unsigned char active;      // The SPI is shifting out a byte
+} dispTx_t;
 
 
 // ****** Functions ******
@@ -87,23 +178,48 @@ void            disp_SetCSLow               (void);
 void            disp_SetRSTHigh             (void);
 void            disp_SetRSTLow              (void);
 void            Task_Disp                   (void);
+void            disp_RunCommand             (void);
 void            disp_InitTask               (unsigned int us_per_tick);
 void            disp_Init                   (void);
-unsigned char   disp_SendByte               (unsigned char data);
+unsigned char   disp_SendByte               (unsigned char data, unsigned char a0);
 unsigned char   disp_SendCommand            (unsigned char command);
 unsigned char   disp_SendData               (unsigned char data);
+void            disp_TrackAddress           (unsigned char command);
+unsigned char   disp_ShadowEqual            (unsigned char page, unsigned char column, unsigned char data);
+unsigned char   disp_TxPush                 (unsigned char data, unsigned char a0);
+unsigned char   disp_TxFree                 (void);
+void            disp_TxNext                 (void);
 unsigned char   disp_IsBusy                 (void);
+unsigned char   disp_QueueFree              (void);
+unsigned char   disp_QueueNext              (void);
+dispCall_t*     disp_QueuePush              (unsigned char cmd);
 void            disp_Clear                  (void);
+void            disp_FillRect               (void);
 void            disp_WriteHorizontalLine    (void);
 void            disp_WriteVerticalLine      (void);
 void            disp_WriteChar              (void);
 void            disp_WriteDigit             (void);
+void            disp_SeekDigitColumn        (void);
+unsigned char   disp_NextDigitColumn        (void);
 void            disp_WriteString            (void);
 void            disp_WriteNumber            (void);
+void            disp_BlitString             (void);
+void            disp_SeekBlitColumn         (void);
+void            disp_LoadBlitGlyph          (void);
+unsigned char   disp_NextBlitColumn         (void);
+void            disp_PlotColumn             (void);
+unsigned char   disp_GetPlotByte            (void);
+const __flash unsigned char* disp_GetCharGlyph (unsigned char character);
 void            disp_SetCursorX             (unsigned char x);
 void            disp_SetLine                (unsigned char line);
 unsigned char   disp_CallByValue            (unsigned char cmd, unsigned char arg0, unsigned char arg1, unsigned char arg2);
 unsigned char   disp_CallByReference        (unsigned char cmd, char* pointer);
+void            disp_SetStamp               (unsigned int stamp);
+void            disp_RecordLatency          (unsigned int ticks);
+dispLatency_t*  disp_GetLatency             (void);
+unsigned int    disp_GetLatencyMean         (void);
+void            disp_ResetLatency           (void);
+unsigned char   disp_CallFillRect           (unsigned char page_first, unsigned char page_last, unsigned char x_start, unsigned char x_end, unsigned char pattern);
 void            disp_BacklightON            (void);
 void            disp_BacklightOFF           (void);
 void            disp_BacklightToggle        (void);
@@ -0,0 +1,179 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    glyph.h
+ * @brief   Glyph tables of the fonts in the order they are sent to the display.
+ *          Generated by 06_Simulation/GenerateGlyphs.py, do not edit!
+ * @details
+ * - Glyphs: 0x07-0x0B,0x20-0x7E
+ * - glyph_font[index][column]: The columns of a character, index from glyph_font_index.
+ * - glyph_digit[digit][row][column]: The columns of a digit for each page.
+ ******************************************************************************
+ */
+
+#ifndef GLYPH_H_
+#define GLYPH_H_
+
+// ****** Defines ******
+#define FONT_X 6
+#define FONT_Y 8
+#define DIGIT_X 12
+#define DIGIT_Y 16
+#define GLYPH_FONT_FIRST    0x07 // The first character in the index table
+#define GLYPH_FONT_LAST     0x7E // The last character in the index table
+#define GLYPH_FONT_COUNT    101 // The number of glyphs in the character table
+#define GLYPH_DIGIT_FIRST   0x2C // The first character of the digit table
+#define GLYPH_DIGIT_COUNT   15 // The number of glyphs in the digit table
+
+// ****** Tables ******
+const __flash unsigned char glyph_font_index[GLYPH_FONT_LAST - GLYPH_FONT_FIRST + 1]={
+	  1,  2,  3,  4,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	  0,  0,  0,  0,  0,  0,  0,  0,  0,  6,  7,  8,  9, 10, 11, 12,
+	 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28,
+	 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44,
+	 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60,
+	 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
+	 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92,
+	 93, 94, 95, 96, 97, 98, 99,100
+};
+
+const __flash unsigned char glyph_font[GLYPH_FONT_COUNT][FONT_X]={
+{0x00,0x00,0x00,0x00,0x00,0x00},	// blank
+{0x7E,0x42,0x42,0x42,0x7E,0x18},	// 0x07
+{0x7E,0x7E,0x42,0x42,0x7E,0x18},	// 0x08
+{0x7E,0x7E,0x7E,0x42,0x7E,0x18},	// 0x09
+{0x7E,0x7E,0x7E,0x7E,0x7E,0x18},	// 0x0A
+{0x0E,0x36,0x4A,0x48,0x30,0x00},	// 0x0B
+{0x00,0x00,0x00,0x00,0x00,0x00},	// 0x20
+{0x00,0x06,0x5F,0x06,0x00,0x00},	// 0x21
+{0x03,0x07,0x00,0x03,0x07,0x00},	// 0x22
+{0x24,0x7E,0x24,0x7E,0x24,0x00},	// 0x23
+{0x00,0x12,0x6A,0x2B,0x24,0x00},	// 0x24
+{0x63,0x64,0x08,0x13,0x63,0x00},	// 0x25
+{0x50,0x20,0x56,0x49,0x36,0x00},	// 0x26
+{0x00,0x00,0x03,0x07,0x00,0x00},	// 0x27
+{0x00,0x00,0x41,0x3E,0x00,0x00},	// 0x28
+{0x00,0x00,0x3E,0x41,0x00,0x00},	// 0x29
+{0x08,0x3E,0x1C,0x3E,0x08,0x00},	// 0x2A
+{0x08,0x08,0x3E,0x08,0x08,0x00},	// 0x2B
+{0x00,0x00,0x60,0xE0,0x00,0x00},	// 0x2C
+{0x08,0x08,0x08,0x08,0x08,0x00},	// 0x2D
+{0x00,0x00,0x60,0x60,0x00,0x00},	// 0x2E
+{0x02,0x04,0x08,0x10,0x20,0x00},	// 0x2F
+{0x3E,0x45,0x49,0x51,0x3E,0x00},	// 0x30
+{0x00,0x40,0x7F,0x42,0x00,0x00},	// 0x31
+{0x46,0x49,0x49,0x51,0x62,0x00},	// 0x32
+{0x36,0x49,0x49,0x49,0x22,0x00},	// 0x33
+{0x10,0x7F,0x12,0x14,0x18,0x00},	// 0x34
+{0x31,0x49,0x49,0x49,0x2F,0x00},	// 0x35
+{0x30,0x49,0x49,0x4A,0x3C,0x00},	// 0x36
+{0x03,0x05,0x09,0x71,0x01,0x00},	// 0x37
+{0x36,0x49,0x49,0x49,0x36,0x00},	// 0x38
+{0x1E,0x29,0x49,0x49,0x06,0x00},	// 0x39
+{0x00,0x00,0x6C,0x6C,0x00,0x00},	// 0x3A
+{0x00,0x00,0x6C,0xEC,0x00,0x00},	// 0x3B
+{0x00,0x41,0x22,0x14,0x08,0x00},	// 0x3C
+{0x24,0x24,0x24,0x24,0x24,0x00},	// 0x3D
+{0x08,0x14,0x22,0x41,0x00,0x00},	// 0x3E
+{0x06,0x09,0x59,0x01,0x02,0x00},	// 0x3F
+{0x1E,0x55,0x5D,0x41,0x3E,0x00},	// 0x40
+{0x7E,0x11,0x11,0x11,0x7E,0x00},	// 0x41
+{0x36,0x49,0x49,0x49,0x7F,0x00},	// 0x42
+{0x22,0x41,0x41,0x41,0x3E,0x00},	// 0x43
+{0x3E,0x41,0x41,0x41,0x7F,0x00},	// 0x44
+{0x41,0x49,0x49,0x49,0x7F,0x00},	// 0x45
+{0x01,0x09,0x09,0x09,0x7F,0x00},	// 0x46
+{0x7A,0x49,0x49,0x41,0x3E,0x00},	// 0x47
+{0x7F,0x08,0x08,0x08,0x7F,0x00},	// 0x48
+{0x00,0x41,0x7F,0x41,0x00,0x00},	// 0x49
+{0x3F,0x40,0x40,0x40,0x30,0x00},	// 0x4A
+{0x41,0x22,0x14,0x08,0x7F,0x00},	// 0x4B
+{0x40,0x40,0x40,0x40,0x7F,0x00},	// 0x4C
+{0x7F,0x02,0x04,0x02,0x7F,0x00},	// 0x4D
+{0x7F,0x08,0x04,0x02,0x7F,0x00},	// 0x4E
+{0x3E,0x41,0x41,0x41,0x3E,0x00},	// 0x4F
+{0x06,0x09,0x09,0x09,0x7F,0x00},	// 0x50
+{0x5E,0x21,0x51,0x41,0x3E,0x00},	// 0x51
+{0x66,0x19,0x09,0x09,0x7F,0x00},	// 0x52
+{0x32,0x49,0x49,0x49,0x26,0x00},	// 0x53
+{0x01,0x01,0x7F,0x01,0x01,0x00},	// 0x54
+{0x3F,0x40,0x40,0x40,0x3F,0x00},	// 0x55
+{0x1F,0x20,0x40,0x20,0x1F,0x00},	// 0x56
+{0x3F,0x40,0x3C,0x40,0x3F,0x00},	// 0x57
+{0x63,0x14,0x08,0x14,0x63,0x00},	// 0x58
+{0x07,0x08,0x70,0x08,0x07,0x00},	// 0x59
+{0x00,0x43,0x45,0x49,0x71,0x00},	// 0x5A
+{0x00,0x41,0x41,0x7F,0x00,0x00},	// 0x5B
+{0x20,0x10,0x08,0x04,0x02,0x00},	// 0x5C
+{0x00,0x7F,0x41,0x41,0x00,0x00},	// 0x5D
+{0x04,0x02,0x01,0x02,0x04,0x00},	// 0x5E
+{0x80,0x80,0x80,0x80,0x80,0x80},	// 0x5F
+{0x00,0x00,0x07,0x03,0x00,0x00},	// 0x60
+{0x78,0x54,0x54,0x54,0x20,0x00},	// 0x61
+{0x38,0x44,0x44,0x44,0x7F,0x00},	// 0x62
+{0x28,0x44,0x44,0x44,0x38,0x00},	// 0x63
+{0x7F,0x44,0x44,0x44,0x38,0x00},	// 0x64
+{0x08,0x54,0x54,0x54,0x38,0x00},	// 0x65
+{0x00,0x09,0x09,0x7E,0x08,0x00},	// 0x66
+{0x7C,0xA4,0xA4,0xA4,0x18,0x00},	// 0x67
+{0x00,0x78,0x04,0x04,0x7F,0x00},	// 0x68
+{0x00,0x40,0x7D,0x00,0x00,0x00},	// 0x69
+{0x00,0x7D,0x84,0x80,0x40,0x00},	// 0x6A
+{0x00,0x44,0x28,0x10,0x7F,0x00},	// 0x6B
+{0x00,0x40,0x7F,0x00,0x00,0x00},	// 0x6C
+{0x78,0x04,0x18,0x04,0x7C,0x00},	// 0x6D
+{0x00,0x78,0x04,0x04,0x7C,0x00},	// 0x6E
+{0x38,0x44,0x44,0x44,0x38,0x00},	// 0x6F
+{0x38,0x44,0x44,0x44,0xFC,0x00},	// 0x70
+{0xFC,0x44,0x44,0x44,0x38,0x00},	// 0x71
+{0x08,0x04,0x44,0x78,0x44,0x00},	// 0x72
+{0x20,0x54,0x54,0x54,0x08,0x00},	// 0x73
+{0x00,0x24,0x44,0x3E,0x04,0x00},	// 0x74
+{0x00,0x7C,0x20,0x40,0x3C,0x00},	// 0x75
+{0x1C,0x20,0x40,0x20,0x1C,0x00},	// 0x76
+{0x3C,0x60,0x30,0x60,0x3C,0x00},	// 0x77
+{0x00,0x6C,0x10,0x10,0x6C,0x00},	// 0x78
+{0x00,0x3C,0x60,0xA0,0x9C,0x00},	// 0x79
+{0x00,0x4C,0x54,0x54,0x64,0x00},	// 0x7A
+{0x00,0x41,0x41,0x3E,0x08,0x00},	// 0x7B
+{0x00,0x00,0x77,0x00,0x00,0x00},	// 0x7C
+{0x08,0x3E,0x41,0x41,0x00,0x00},	// 0x7D
+{0x00,0x01,0x02,0x01,0x02,0x00}	// 0x7E
+};
+
+const __flash unsigned char glyph_digit[GLYPH_DIGIT_COUNT][2][DIGIT_X]={
+{{0x00,0x00,0x00,0x00,0x00,0x78,0xF8,0xB8,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}},	// 0x2C
+{{0x00,0x00,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x00,0x00},{0x00,0x00,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x00,0x00}},	// 0x2D
+{{0x00,0x00,0x00,0x00,0x00,0x38,0x38,0x38,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}},	// 0x2E
+{{0x00,0x00,0x00,0x00,0x00,0x01,0x03,0x07,0x0E,0x1C,0x18,0x00},{0x0E,0x1C,0x38,0x70,0xE0,0xC0,0x80,0x00,0x00,0x00,0x00,0x00}},	// 0x2F
+{{0x07,0x1F,0x18,0x30,0x30,0x30,0x31,0x33,0x1E,0x1F,0x07,0x00},{0xF8,0xFE,0x1E,0x33,0x63,0xC3,0x83,0x03,0x06,0xFE,0xF8,0x00}},	// 0x30
+{{0x00,0x30,0x30,0x30,0x3F,0x3F,0x30,0x30,0x30,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0xFF,0xFF,0x0E,0x0C,0x0C,0x00,0x00,0x00}},	// 0x31
+{{0x30,0x30,0x30,0x30,0x31,0x33,0x37,0x3E,0x3C,0x38,0x30,0x00},{0x1C,0x3E,0x77,0xE3,0xC3,0x83,0x03,0x03,0x07,0x1E,0x1C,0x00}},	// 0x32
+{{0x0E,0x1F,0x39,0x30,0x30,0x30,0x30,0x30,0x38,0x1C,0x0C,0x00},{0x3C,0x7E,0xE7,0xC3,0xC3,0xC3,0xC3,0xC3,0x07,0x0E,0x0C,0x00}},	// 0x33
+{{0x03,0x03,0x3F,0x3F,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x00},{0x00,0x00,0xFF,0xFF,0x07,0x0E,0x1C,0x38,0x70,0xE0,0xC0,0x00}},	// 0x34
+{{0x0F,0x1F,0x38,0x30,0x30,0x30,0x30,0x30,0x38,0x1C,0x0C,0x00},{0x83,0xC3,0xE3,0x63,0x63,0x63,0x63,0x63,0x63,0x7F,0x3F,0x00}},	// 0x35
+{{0x0F,0x1F,0x39,0x30,0x30,0x30,0x30,0x30,0x39,0x1F,0x0F,0x00},{0x00,0x80,0xC3,0xC3,0xC3,0xC7,0xCE,0xDC,0xF8,0xF0,0xC0,0x00}},	// 0x36
+{{0x00,0x00,0x00,0x00,0x03,0x0F,0x3C,0x30,0x00,0x00,0x00,0x00},{0x03,0x0F,0x3F,0xF3,0xC3,0x03,0x03,0x03,0x03,0x03,0x03,0x00}},	// 0x37
+{{0x0F,0x1F,0x39,0x30,0x30,0x30,0x30,0x30,0x39,0x1F,0x0F,0x00},{0x00,0xBC,0xFE,0xE7,0xC3,0xC3,0xC3,0xE7,0xFE,0xBC,0x00,0x00}},	// 0x38
+{{0x00,0x03,0x07,0x0E,0x1C,0x38,0x30,0x30,0x30,0x00,0x00,0x00},{0xFC,0xFE,0xE7,0xC3,0xC3,0xC3,0xC3,0xC3,0xE7,0x7E,0x3C,0x00}},	// 0x39
+{{0x00,0x00,0x00,0x00,0x00,0x1C,0x1C,0x1C,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x70,0x70,0x70,0x00,0x00,0x00,0x00}}	// 0x3A
+};
+#endif
\ No newline at end of file
@@ -23,13 +23,49 @@
 #include "oScale.h"
 
 // ****** Defines ******
+// Task group of the GUI task, it runs with the sample rate of the graph and when a screen is drawn
+#ifndef GUI_TASK
+#define GUI_TASK        TASK3
+#endif
+
 // Page appearance
 #define GUI_LINE_VALUES 4 // The line where the values are displayed
 #define GUI_LINE_UNITS  7 // The line where the units are displayed
+#define GUI_INIT_CALLS  8 // The number of display commands to draw the static screen content
+
+// Weight graph, swept from the left to the right below the weight
+#define GUI_GRAPH_PAGE_FIRST    6   // The first page of the graph
+#define GUI_GRAPH_PAGE_LAST     6   // The last page of the graph
+#define GUI_GRAPH_COL_FIRST     67  // The lowest RAM column of a sample, the gap before it has to be free
+#define GUI_GRAPH_COL_LAST      127 // The highest RAM column of a sample
+#define GUI_GRAPH_FULL_SCALE    500 // The weight at the top of the graph in 0.1 g
+#define GUI_GRAPH_RATE_ms       100 // The time between two samples of the graph
+#define GUI_GRAPH_HEIGHT        (8 * (GUI_GRAPH_PAGE_LAST - GUI_GRAPH_PAGE_FIRST + 1)) // Height in pixels
+#define GUI_GRAPH_TICKS         ((GUI_GRAPH_RATE_ms * 1000UL) / SYSTICK_us) // SysTicks per sample
+
+#if GUI_GRAPH_HEIGHT > 16
+#error "The weight graph can only be 1 or 2 pages high!"
+#endif
+
+#if GUI_LINE_VALUES != DISP_SHADOW_PAGE
+#warning "The values are not in the shadow region of the display, every frame is sent completely!"
+#endif
+
+#if GUI_INIT_CALLS > DISP_QUEUE_SIZE
+#error "The static screen content does not fit into the display queue!"
+#endif
 
 // Screens to display
 #define GUI_SCREEN_MANUAL   GUI_CMD_MANUAL  // The screen during manual operation
 
+typedef struct  // State of the weight graph
+{
+    unsigned char active;   // The static screen is written and the graph can be plotted
+    unsigned char column;   // The RAM column of the next sample
+    unsigned char pixel;    // The pixel of the previous sample
+    unsigned int stamp;     // SysTick of the next sample
+} guiGraph_t;
+
 // Arbiter Commands
 #define GUI_CMD_INIT    1 // Initialize the GUI Screen
 #define GUI_CMD_MANUAL  2 // Display the data during manual operation
@@ -43,6 +79,7 @@ unsigned char   gui_WriteString     (unsigned char x, unsigned char line, char *
 unsigned char   gui_WriteWeight     (void);
 unsigned char   gui_WriteTime       (void);
 unsigned char   gui_WriteBattery    (void);
+void            gui_UpdateGraph     (void);
 unsigned char   GUI_Draw            (unsigned char screen);
 char*           GUI_Num2Str         (char* dest, unsigned int int_number, unsigned char precision);
 #endif
\ No newline at end of file
@@ -46,12 +46,51 @@
  * => Schedule_Max_us = (2^16 - 1) * SYSTICK_us
  */
 #define SYSTICK_us  200U     // SysTick interrupt is every 200 us (5 kHz)
-#define TASK0_us    200U     // Run TASK0 every 200 us (5 kHz)
-#define TASK1_ms    10U      // Run TASK1 every 10 ms (100 Hz)
+#define TASK1_ms    10U      // Sample the ADC every 10 ms (100 Hz), TASK1 filters the samples
 #define TASK2_ms    200U     // Run TASK2 every 200 ms (5 Hz)
+#define TASK3_ms    GUI_GRAPH_RATE_ms // Run TASK3 with the sample rate of the weight graph
+
+/*
+ * Task Table
+ * Every entry is X(task group, period in us, task function).
+ * The task group is also the priority, when several groups are waiting
+ * the lower group runs first. The functions of one group run in the order
+ * of the table and have to use the same period.
+ * A period of 0 schedules a group without a timer, it only runs on events
+ * (post_event, post_event_isr or post_tick).
+ * The periods are converted to SysTicks at compile time and checked in main.c.
+ */
+#define SYS_TASK_TABLE(X)                       \
+    X(DISP_TASK, 0,                 Task_Disp)  \
+    X(ADC_TASK, 0,                  Task_ADC)   \
+    X(TASK2, TASK2_ms * 1000UL,     Task_SYS)   \
+    X(GUI_TASK, TASK3_ms * 1000UL,  Task_GUI)
+
+#define SYS_TICKS(period_us)    ((period_us) / SYSTICK_us) // The period of a task in SysTicks
 
 #define GUI_DRAW_RATE   2    // Update GUI every n TaskTicks of Task_SYS
 
+// Low rate profile when the scale is idle
+#ifndef SYS_LOW_RATE
+#define SYS_LOW_RATE    1    // Slow down TASK2 while the weight is stable and the timer is stopped
+#endif
+#define TASK2_LOW_ms    1000U // Run TASK2 every 1 s (1 Hz) in the low rate profile
+#define SYS_IDLE_s      10U  // Seconds of a stable weight until the low rate profile is used
+#define SYS_IDLE_DELTA  5    // Largest change of the weight in 0.1 g which is still stable
+#define SYS_IDLE_RUNS   ((SYS_IDLE_s * 1000UL) / TASK2_ms) // Runs of TASK2 until the low rate profile is used
+
+#if SYS_IDLE_RUNS > 255
+#error "SYS_IDLE_s is too long for the idle counter!"
+#endif
+
+// Keeps the compiler from moving memory accesses across it
+#define SYS_BARRIER()   __asm__ __volatile__("" ::: "memory")
+
+// Idle mode
+#ifndef SYS_SLEEP_IDLE
+#define SYS_SLEEP_IDLE  1    // Sleep in SLEEP_MODE_IDLE until the next interrupt when all tasks are done
+#endif
+
 // pins
 #define DDR_IO      DDRD
 #define PORT_IO     PORTD
@@ -62,6 +101,7 @@
 #define KEY1        PD2
 #define KEY2        PD3
 #define KEY3        PD4
+#define KEY_PCINT   ((1<<PCINT16) | (1<<PCINT18) | (1<<PCINT19) | (1<<PCINT20)) // Pin change interrupts of the keys
 
 // System states
 #define SYS_STATE_INIT      1
@@ -78,6 +118,7 @@ typedef struct
     unsigned int Time;      // Elapsed time in [s]
     unsigned int FlowRate;  // Current Flow Rate in [g/s]
     unsigned char SoC;      // Battery Soc in [%]
+    unsigned int Stamp;     // SysTick of the ADC sample of the weight
 } ScaleDat_t;
 #pragma pack(pop)
 
@@ -91,6 +132,9 @@ typedef struct
     unsigned char KeyState[2];      // Contains the old and new state of the keys
     signed int Calibration[2];   // Calibration coefficients
     signed int WeightOffset;      // The current offset of the weight, used for zeroing the scale
+    signed int WeightIdle;        // The weight when the scale became stable
+    unsigned char CounterIdle;    // Runs of TASK2 until the low rate profile is used
+    unsigned char RateLow;        // The low rate profile is active
 } SysDat_t;
 #pragma pack(pop)
 
@@ -99,7 +143,10 @@ void            Task_SYS                (void);
 void            scale_StateManual       (void);
 void            scale_StateShutdown     (void);
 void            scale_InitTask          (void);
-ScaleDat_t*     Scale_GetIPC            (void);
+void            scale_BeginWrite        (void);
+void            scale_EndWrite          (void);
+unsigned char   scale_TryGetSnapshot    (ScaleDat_t* snapshot);
+void            scale_GetSnapshot       (ScaleDat_t* snapshot);
 void            scale_SetONHigh         (void);
 void            scale_SetONLow          (void);
 unsigned char   scale_GetKeyPressed     (void);
@@ -109,5 +156,7 @@ void            scale_StartSysTick      (void);
 void            scale_StopSysTick       (void);
 void            scale_UpdateGUI         (void);
 int             scale_ConvertSample     (unsigned int i_Sample);
+signed int      scale_GetWeight         (void);
 void            scale_GetSoC            (void);
+void            scale_UpdateRate        (unsigned char keys);
 #endif
\ No newline at end of file
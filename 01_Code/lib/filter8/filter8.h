@@ -21,6 +21,14 @@
 #define FILTER8_H_
 
 // ****** Defines ******
+// Fixed point format of the biquad coefficients: Q2.14, the range is [-2, 2)
+#define BIQUAD_Q        14
+#define BIQUAD_ONE      (1L << BIQUAD_Q)
+
+// Bound of the L1 norm of the impulse response in quarters, the output is below gain * input
+#define BIQUAD_GAIN_LP      6   // Low-pass with F0 <= Fs/4: 1.3
+#define BIQUAD_GAIN_NOTCH   10  // Notch: 2.5
+
 // Struct for filtered data
 // #pragma pack(push, 1)
 // typedef struct
@@ -43,10 +51,78 @@ typedef struct
     unsigned char ExtraBits;    // Number of extra bits for the internal calculations
 } IIR_Filter_t;
 
+// Struct for a decimator, a CIC filter of first order (accumulate and dump)
+typedef struct
+{
+    unsigned long Sum;          // Accumulated samples of the current output
+    unsigned int Value;         // The last output of the decimator
+    unsigned char Count;        // Number of samples in the sum
+    unsigned char Rate;         // Decimation rate, the number of samples per output
+    unsigned char Shift;        // Bitshift of the output which keeps it within 16 bits
+} Decimator_t;
+
+// Struct for a biquad, one second order section in Direct Form I
+typedef struct
+{
+    signed int x[2];            // The last input samples x1, x2
+    signed int y[2];            // The last output values y1, y2
+    signed int b[3];            // Coefficients for filter nominator in Q2.14
+    signed int a[2];            // Coefficients a1, a2 for filter denominator in Q2.14, a0 is 1
+    unsigned int Error;         // Truncated fraction of the last output, fed back into the next one
+} Biquad_t;
+
+/*
+ * Initializers with the coefficients calculated at compile time.
+ * They give the same filters as the Create functions, without calculating
+ * the coefficients on the target: the filters can be declared initialized
+ * and the 64-bit math of CreatePT1() is not linked. Reset the state with
+ * the Reset functions when a filter is started again.
+ */
+// PT1 like CreatePT1(), t * fs has to fit into 16 bits
+#define PT1_A1(fs, t, sample_bits, extra_bits) \
+    ((unsigned long)((((unsigned long long)(t) * (fs)) << ((30 - (sample_bits)) - (extra_bits))) \
+    / (1000ULL + (unsigned long long)(t) * (fs))))
+#define PT1_B0(fs, gain, t, sample_bits) \
+    ((unsigned long)(((((unsigned long long)(gain) * 1000ULL) << (30 - (sample_bits))) \
+    / (1000ULL + (unsigned long long)(t) * (fs))) / 100))
+#define PT1_INIT(fs, gain, t, sample_bits, extra_bits) { \
+    .x = {0, 0, 0}, .y = {0, 0, 0}, \
+    .a = {1, PT1_A1(fs, t, sample_bits, extra_bits), 0}, \
+    .b = {PT1_B0(fs, gain, t, sample_bits), 0, 0}, \
+    .ScaleBits = 30 - (sample_bits), .ExtraBits = (extra_bits) }
+
+// Decimator like CreateDecimator(), the shift keeps the largest sum within 16 bits
+#define DECIMATOR_MAX(rate, sample_bits)   (((1UL << (sample_bits)) - 1) * (rate))
+#define DECIMATOR_SHIFT(rate, sample_bits) ( \
+    (DECIMATOR_MAX(rate, sample_bits) > 0x0FFFFUL) + (DECIMATOR_MAX(rate, sample_bits) > 0x1FFFFUL) + \
+    (DECIMATOR_MAX(rate, sample_bits) > 0x3FFFFUL) + (DECIMATOR_MAX(rate, sample_bits) > 0x7FFFFUL) + \
+    (DECIMATOR_MAX(rate, sample_bits) > 0xFFFFFUL) + (DECIMATOR_MAX(rate, sample_bits) > 0x1FFFFFUL) + \
+    (DECIMATOR_MAX(rate, sample_bits) > 0x3FFFFFUL) + (DECIMATOR_MAX(rate, sample_bits) > 0x7FFFFFUL))
+#define DECIMATOR_INIT(rate, sample_bits) { \
+    .Sum = 0, .Value = 0, .Count = 0, .Rate = (rate), \
+    .Shift = DECIMATOR_SHIFT(rate, sample_bits) }
+
+// Biquad with the Q2.14 coefficients of 06_Simulation/GenerateBiquads.py
+#define BIQUAD_INIT(b0, b1, b2, a1, a2) { \
+    .x = {0, 0}, .y = {0, 0}, .b = {b0, b1, b2}, .a = {a1, a2}, .Error = 0 }
+
 // ****** Functions ******
 unsigned char   CreatePT1       (IIR_Filter_t* p_Filter, unsigned int Fs, unsigned int Gain, unsigned int T, unsigned char SampleBits, unsigned char ExtraBits);
 unsigned int    ApplyPT1        (IIR_Filter_t* p_Filter, unsigned int i_Sample_New);
 unsigned int    GetIIR          (IIR_Filter_t* p_Filter);
+void            ResetIIR        (IIR_Filter_t* p_Filter);
+unsigned char   CreateDecimator (Decimator_t* p_Decimator, unsigned char Rate, unsigned char SampleBits);
+unsigned char   ApplyDecimator  (Decimator_t* p_Decimator, unsigned int i_Sample_New);
+unsigned int    GetDecimator    (Decimator_t* p_Decimator);
+void            ResetDecimator  (Decimator_t* p_Decimator);
+unsigned char   CreateBiquad    (Biquad_t* p_Biquad, const signed int* b, const signed int* a, unsigned char SampleBits, unsigned char Gain);
+unsigned char   CreateButterworthLP (Biquad_t* p_Biquad, unsigned int Fs, unsigned long F0, unsigned char SampleBits);
+unsigned char   CreateCriticalLP    (Biquad_t* p_Biquad, unsigned int Fs, unsigned long F0, unsigned char SampleBits);
+unsigned char   CreateNotch     (Biquad_t* p_Biquad, unsigned int Fs, unsigned long F0, unsigned int Q, unsigned char SampleBits);
+signed int      ApplyBiquad     (Biquad_t* p_Biquad, signed int i_Sample_New);
+signed int      ApplyBiquadCascade  (Biquad_t* p_Biquad, unsigned char Sections, signed int i_Sample_New);
+signed int      GetBiquad       (Biquad_t* p_Biquad);
+void            ResetBiquad     (Biquad_t* p_Biquad);
 // void            FilterAVG           (unsigned int i_Sample_New, Filter_t* p_Filter);
 // void            FilterPT1           (unsigned int i_Sample_New, Filter_t* p_Filter);
 #endif
\ No newline at end of file
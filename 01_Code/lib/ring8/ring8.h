@@ -0,0 +1,123 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    ring8.h
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Lock-free ring buffer for one producer and one consumer, e.g. an
+ *          interrupt and the main loop. Optimized for 8-bit systems.
+ * @details
+ * RING8_DECLARE(name, type, size) declares the struct name_t and its functions
+ * for the element type and the size, which has to be a power of 2 and not
+ * greater than 128:
+ * - name_init:  Empty the ring, only when neither side uses it.
+ * - name_push:  Producer, copy one element into the ring.
+ * - name_pop:   Consumer, copy the oldest element out of the ring.
+ * - name_front: Consumer, get the oldest element in place, name_drop releases it.
+ * - name_count: The number of elements in the ring.
+ * - name_free:  The number of free slots.
+ *
+ * Protocol:
+ * The indices are free-running bytes, only the lower bits address the buffer,
+ * so head - tail is the number of elements and a full ring is distinguished
+ * from an empty one. The producer only writes head and the consumer only
+ * writes tail. Byte accesses are atomic on the AVR, so neither side has to
+ * disable the interrupts. An element is written before head is advanced and
+ * read before tail is advanced, the barrier keeps the compiler from moving
+ * the element access behind the index update.
+ ******************************************************************************
+ */
+#ifndef RING8_H_
+#define RING8_H_
+
+// ****** Defines ******
+// Compiler barrier, the host also needs a memory barrier when the test runs the sides in threads
+#ifdef __AVR__
+#define RING8_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define RING8_BARRIER() __sync_synchronize()
+#endif
+
+#define RING8_DECLARE(name, type, size)                                         \
+_Static_assert(((size) & ((size) - 1)) == 0, #name ": The size has to be a power of 2!"); \
+_Static_assert(((size) > 0) && ((size) <= 128), #name ": The size has to be between 1 and 128!"); \
+                                                                                \
+typedef struct                                                                  \
+{                                                                               \
+    type buffer[size];                                                          \
+    volatile unsigned char head;    /* Write index, only changed by the producer */ \
+    volatile unsigned char tail;    /* Read index, only changed by the consumer */  \
+} name##_t;                                                                     \
+                                                                                \
+static inline void name##_init(name##_t* ring)                                  \
+{                                                                               \
+    ring->head = 0;                                                             \
+    ring->tail = 0;                                                             \
+}                                                                               \
+                                                                                \
+static inline unsigned char name##_count(name##_t* ring)                        \
+{                                                                               \
+    return (unsigned char)(ring->head - ring->tail);                            \
+}                                                                               \
+                                                                                \
+static inline unsigned char name##_free(name##_t* ring)                         \
+{                                                                               \
+    return (unsigned char)((size) - (unsigned char)(ring->head - ring->tail));  \
+}                                                                               \
+                                                                                \
+static inline unsigned char name##_push(name##_t* ring, type value)             \
+{                                                                               \
+    unsigned char _head = ring->head;                                           \
+    if ((unsigned char)(_head - ring->tail) >= (size))                          \
+        return 0;                                                               \
+    ring->buffer[_head & ((size) - 1)] = value;                                 \
+    RING8_BARRIER();                                                            \
+    ring->head = _head + 1;                                                     \
+    return 1;                                                                   \
+}                                                                               \
+                                                                                \
+static inline type* name##_front(name##_t* ring)                                \
+{                                                                               \
+    unsigned char _tail = ring->tail;                                           \
+    if (ring->head == _tail)                                                    \
+        return 0;                                                               \
+    RING8_BARRIER();                                                            \
+    return &ring->buffer[_tail & ((size) - 1)];                                 \
+}                                                                               \
+                                                                                \
+static inline void name##_drop(name##_t* ring)                                  \
+{                                                                               \
+    RING8_BARRIER();                                                            \
+    ring->tail = ring->tail + 1;                                                \
+}                                                                               \
+                                                                                \
+static inline unsigned char name##_pop(name##_t* ring, type* value)             \
+{                                                                               \
+    type* _front = name##_front(ring);                                          \
+    if (!_front)                                                                \
+        return 0;                                                               \
+    *value = *_front;                                                           \
+    name##_drop(ring);                                                          \
+    return 1;                                                                   \
+}
+
+#endif
@@ -42,14 +42,24 @@ void scheduler_init(unsigned char SysTick_us)
 	// os = ipc_memory_register(sizeof(schedule_t),did_SCHEDULER);
 
 	//initialize the parameters for every task
+	os.active	= 0; //No task is active
+	os.ready	= 0; //No task wants to run
+	os.taken	= 0;
+	os.periodic	= 0; //No task has a timer
+	os.event	= 0; //No event is posted
+	os.tick_req	= 0;
+	os.tick_ack	= 0;
+	os.resched_req = 0; //No new schedule is pending
+	os.resched_ack = 0;
+	os.head		= NO_TASK; //The delta list is empty
 	for(unsigned char count=0;count<NUM_TASKS;count++)
 	{
-		os.active[count]	= 0; //Task is not active
-		os.flag[count]		= 0; //No task wants to run
-		os.timer[count]	    = 0; //Reset the timer of the task
 		os.schedule[count]	= 0; //Reset the schedule of the task
+		reset_exec_time(count); //No execution time is measured
 	}
 	os.loop_ovf = 0; //No loop overflow occurred
+	os.ticks = 0; //Start the time stamps at 0
+	reset_duty_cycle(); //No busy time is counted
 	os.tick_time = SysTick_us;
 };
 
@@ -57,12 +67,115 @@ void scheduler_init(unsigned char SysTick_us)
  * @brief Schedule one task, the task is automatically set active!
  * @param task The number of the task(group).
  * @param schedule The schedule of the task as a multiple of the SysTick ticks.
+ * @return Returns 1 when the schedule was accepted, 0 when the schedule is 0.
+ * @details A schedule of 0 would wrap the reload value to 0xFFFF, the task
+ * is left unchanged then. Tasks without a period use schedule_event().
  */
-void schedule(unsigned char task, unsigned int schedule)
+unsigned char schedule(unsigned char task, unsigned int schedule)
 {
-	set_task(task,ACTIVE);	//Set task active
+	if(schedule == 0)
+		return 0;
+
+	set_task(task,INACTIVE); //Take the task out of the delta list
 	os.schedule[task] = schedule - 1; //Update schedule
-	os.timer[task]	  = schedule - 1; //Reload the timer
+	os.periodic |= 1<<task;
+	set_task(task,ACTIVE);	//Set task active, this reloads the timer
+	return 1;
+};
+
+/**
+ * @brief Schedule one task without a timer, the task is automatically set active!
+ * @param task The number of the task(group).
+ * @details The task is only started by post_event(), post_event_isr() or
+ * post_tick(), so it costs no dispatch time while it has nothing to do.
+ */
+void schedule_event(unsigned char task)
+{
+	set_task(task,INACTIVE); //Take the task out of the delta list
+	os.periodic &= ~(1<<task);
+	set_task(task,ACTIVE);
+};
+
+/**
+ * @brief Change the schedule of a task while the scheduler is running.
+ * @param task The number of the task(group).
+ * @param schedule The new schedule of the task as a multiple of the SysTick ticks.
+ * @return Returns 1 when the new schedule was accepted, 0 when the previous
+ * change is not applied yet or the schedule is 0.
+ * @details The SysTick applies the schedule with its next tick. The phase of
+ * the task is kept: The next run follows the new period after the last run,
+ * or starts right away when this time already passed.
+ * The reload value is written before the request is toggled and is not
+ * changed until the SysTick acknowledged it, so no interrupts have to be disabled.
+ */
+unsigned char reschedule(unsigned char task, unsigned int schedule)
+{
+	unsigned char _mask = 1<<task;
+	if((schedule == 0) || ((os.resched_req ^ os.resched_ack) & _mask))
+		return 0;
+
+	os.pending[task] = schedule - 1;
+	os.resched_req ^= _mask;
+	return 1;
+};
+
+/**
+ * @brief Apply the pending schedules of reschedule().
+ * @details Called by the SysTick, the remaining time of a periodic task
+ * is shortened or extended by the change of its period.
+ */
+void update_schedules(void)
+{
+	unsigned char _requested = os.resched_req ^ os.resched_ack;
+	for(unsigned char task = 0; _requested; task++, _requested >>= 1)
+	{
+		if(!(_requested & 1))
+			continue;
+
+		unsigned char _mask = 1<<task;
+		unsigned int _old = os.schedule[task];
+		unsigned int _new = os.pending[task];
+		os.schedule[task] = _new;
+		os.resched_ack ^= _mask;
+
+		//Move the task in the delta list, the elapsed time stays the same
+		if((os.active & os.periodic) & _mask)
+		{
+			unsigned int _elapsed = _old - get_timer(task);
+			remove_task(task);
+			insert_task(task, (_new > _elapsed) ? (_new - _elapsed) : 0);
+		}
+	}
+};
+
+/**
+ * @brief Get the schedule of a task.
+ * @param task The number of the task(group).
+ * @return The schedule of the task as a multiple of the SysTick ticks.
+ */
+unsigned int get_schedule(unsigned char task)
+{
+	return os.schedule[task] + 1;
+};
+
+/**
+ * @brief Get the timer of a task in the delta list.
+ * @param task The number of the task(group).
+ * @return The SysTicks until the task expires, counted like the reload value.
+ * Returns 0 when the task is not in the delta list.
+ */
+unsigned int get_timer(unsigned char task)
+{
+	unsigned int _timer = 0;
+	unsigned char _node = os.head;
+	while(_node != NO_TASK)
+	{
+		_timer += os.delta[_node];
+		if(_node == task)
+			return _timer;
+		_node = os.next[_node];
+	}
+	return 0;
 };
 
 /**
@@ -104,10 +217,27 @@ void schedule_ms(unsigned char task, unsigned int schedule_ms)
  * @brief Set a task active or inactive.
  * @param task The number of the task(group).
  * @param state The new state of the task. (ACTIVE or INACTIVE)
+ * @details An active task is in the delta list. The list is also changed
+ * by the SysTick, so this has to be called before the SysTick is started
+ * or with the SysTick interrupt disabled.
  */
 void set_task(unsigned char task, unsigned char state)
 {
-	os.active[task] = state;
+	unsigned char _mask = 1<<task;
+	if(state && !(os.active & _mask))
+	{
+		if(os.periodic & _mask)
+			insert_task(task, os.schedule[task]); //Start the timer of the task
+		os.active |= _mask;
+	}
+	else if(!state && (os.active & _mask))
+	{
+		remove_task(task);
+		os.active &= ~_mask;
+		os.event &= ~_mask; //Discard the waiting run
+		if((os.ready ^ os.taken) & _mask)
+			os.taken ^= _mask;
+	}
 };
 
 /**
@@ -117,58 +247,241 @@ void set_task(unsigned char task, unsigned char state)
  */
 unsigned char get_task(unsigned char task)
 {
-	return os.active[task];
+	return (os.active >> task) & 1;
 };
 
 /**
- * @brief Calculate the run flag for one task.
+ * @brief Insert a task into the delta list.
  * @param task The number of the task(group).
+ * @param timer The SysTicks until the task expires.
+ * @details Every entry only stores the SysTicks after its predecessor
+ * expired, so the SysTick only has to count down the head of the list.
+ * Tasks with the same expiry keep the order in which they were inserted.
  */
-void count_task(unsigned char task)
+void insert_task(unsigned char task, unsigned int timer)
 {
-	if(os.active[task]) 	//only execute when task is active
+	unsigned char _prev = NO_TASK;
+	unsigned char _node = os.head;
+
+	//Find the position in the list
+	while((_node != NO_TASK) && (os.delta[_node] <= timer))
 	{
-		if(os.timer[task]) //When the timer is finished, the task wants to execute
-		{
-			os.timer[task]--;	  	//update the timer count
-			// os.flag[task] = 0;	//Do not set the flag
-		}
-		else //when the timer is not finished, the task does not want to run
-		{
-			os.timer[task] = os.schedule[task]; //Reload the timer with the schedule value
-			os.flag[task] = 1;	//Set the flag for the task
-		}
+		timer -= os.delta[_node];
+		_prev = _node;
+		_node = os.next[_node];
 	}
+
+	//The following task now expires relative to the inserted one
+	if(_node != NO_TASK)
+		os.delta[_node] -= timer;
+	os.delta[task] = timer;
+	os.next[task] = _node;
+	if(_prev == NO_TASK)
+		os.head = task;
 	else
-		os.flag[task] = 0;	//Do not set the flag
+		os.next[_prev] = task;
+};
+
+/**
+ * @brief Remove a task from the delta list.
+ * @param task The number of the task(group).
+ */
+void remove_task(unsigned char task)
+{
+	unsigned char _prev = NO_TASK;
+	unsigned char _node = os.head;
+
+	//Find the task in the list
+	while((_node != NO_TASK) && (_node != task))
+	{
+		_prev = _node;
+		_node = os.next[_node];
+	}
+	if(_node == NO_TASK)
+		return;
+
+	//The following task gets the remaining time of the removed one
+	_node = os.next[task];
+	if(_node != NO_TASK)
+		os.delta[_node] += os.delta[task];
+	if(_prev == NO_TASK)
+		os.head = _node;
+	else
+		os.next[_prev] = _node;
 };
 
 /**
  * @brief Calculate the scheduling for all tasks.
+ * @details Only the head of the delta list is counted down,
+ * the list is only changed when a task expires.
+ * Afterwards the tasks which requested the SysTick with post_tick() are signaled.
  */
 void run_scheduler(void)
 {
-	for(unsigned char task = 0;task<NUM_TASKS;task++)
-		count_task(task);
+	os.ticks++;
+
+	//Apply the new schedules, a task which is moved to this tick expires right away
+	if(os.resched_req ^ os.resched_ack)
+		update_schedules();
+
+	unsigned char _head = os.head;
+	if(_head != NO_TASK)
+	{
+		unsigned int _delta = os.delta[_head];
+		if(_delta) //The head is not expired yet
+			os.delta[_head] = _delta - 1;
+		else
+			expire_tasks();
+	}
+
+	//Acknowledge the requests, tasks which already wait run only once
+	unsigned char _requested = os.tick_req ^ os.tick_ack;
+	if(_requested)
+	{
+		os.tick_ack ^= _requested;
+		os.ready ^= _requested & os.active & ~(os.ready ^ os.taken);
+	}
+};
+
+/**
+ * @brief Signal all tasks which expire in this SysTick and reload their timers.
+ */
+void expire_tasks(void)
+{
+	unsigned char _expired = 0;
+	unsigned char _head = os.head;
+
+	//Take all expired tasks from the head of the list
+	while((_head != NO_TASK) && !os.delta[_head])
+	{
+		_expired |= 1<<_head;
+		_head = os.next[_head];
+	}
+	os.head = _head;
+
+	//The remaining tasks also count this SysTick
+	if(_head != NO_TASK)
+		os.delta[_head]--;
+
+	//Signal the tasks, a task which still waits did not start within its slot
+	unsigned char _waiting = os.ready ^ os.taken;
+	if(_waiting & _expired)
+		os.loop_ovf = 1;
+	os.ready ^= _expired & ~_waiting;
+
+	//Reload the timers
+	for(unsigned char task = 0; _expired; task++, _expired >>= 1)
+	{
+		if(_expired & 1)
+			insert_task(task, os.schedule[task]);
+	}
 };
 
 /**
  * @brief Perform the scheduling and decide whether to run the specified task.
  * @param task The number of the task(group).
  * @return Returns 1 when the task wants to and is allowed to run.
+ * @details The SysTick only writes ready and run() only writes taken,
+ * so no interrupts have to be disabled.
  */
 unsigned char run(unsigned char task)
 {
-	//Check whether the task is scheduled to run
-	if (os.flag[task])
+	unsigned char _mask = 1<<task;
+
+	//Check whether the task is scheduled to run or got an event
+	if(((os.ready ^ os.taken) | os.event) & _mask)
 	{
-		os.flag[task] = 0; 	//Reset the flag of the task
+		take_task(task);	//Reset the flags of the task
 		return 1;			//Task wants to run
 	}
 	else
 		return 0;			//Task does not want to run
 };
 
+/**
+ * @brief Get the next task which wants to run, the lowest task number first.
+ * @return The number of the task(group), NO_TASK when no task wants to run.
+ * @details The waiting tasks are found with a binary bit scan.
+ */
+unsigned char next_task(void)
+{
+	unsigned char _waiting = (os.ready ^ os.taken) | os.event;
+	if(!_waiting)
+		return NO_TASK;
+
+	unsigned char _task = 0;
+	if(!(_waiting & 0x0F))
+	{
+		_waiting >>= 4;
+		_task = 4;
+	}
+	if(!(_waiting & 0x03))
+	{
+		_waiting >>= 2;
+		_task += 2;
+	}
+	if(!(_waiting & 0x01))
+		_task += 1;
+
+	take_task(_task);
+	return _task;
+};
+
+/**
+ * @brief Reset all flags of a task which is started.
+ * @param task The number of the task(group).
+ * @details One run serves the timer, the events and the SysTick requests
+ * which arrived before the task is started.
+ */
+void take_task(unsigned char task)
+{
+	unsigned char _mask = 1<<task;
+	os.event &= ~_mask;
+	if((os.ready ^ os.taken) & _mask)
+		os.taken ^= _mask;
+};
+
+/**
+ * @brief Start a task from another task.
+ * @param task The number of the task(group).
+ * @details Only the main loop writes the event mask, so this must not be
+ * called from an interrupt. The task runs in the current pass of the
+ * dispatcher, inactive tasks ignore the event.
+ */
+void post_event(unsigned char task)
+{
+	os.event |= (1<<task) & os.active;
+};
+
+/**
+ * @brief Start a task from an interrupt.
+ * @param task The number of the task(group).
+ * @details The event is signaled like an expired timer, so this has to be
+ * called from an interrupt or with the interrupts disabled. The task runs
+ * with the next pass of the dispatcher.
+ */
+void post_event_isr(unsigned char task)
+{
+	unsigned char _mask = (1<<task) & os.active;
+	if(!((os.ready ^ os.taken) & _mask))
+		os.ready ^= _mask;
+};
+
+/**
+ * @brief Start a task again with the next SysTick.
+ * @param task The number of the task(group).
+ * @details A task which waits for the hardware or for another task polls
+ * with the SysTick rate, until it has nothing to do anymore. The request
+ * is toggled by the main loop and acknowledged by the SysTick, so no
+ * interrupts have to be disabled.
+ */
+void post_tick(unsigned char task)
+{
+	unsigned char _mask = 1<<task;
+	if(!((os.tick_req ^ os.tick_ack) & _mask))
+		os.tick_req ^= _mask;
+};
+
 /**
  * @brief Indicates whether a loop overflow occurred.
  * @return Returns 1 when an overflow occurred.
@@ -177,3 +490,160 @@ unsigned char schedule_overflow(void)
 {
 	return os.loop_ovf;
 };
+
+/**
+ * @brief Get the number of SysTicks since the start of the scheduler.
+ * @return The current SysTick count, it wraps around after 2^16 ticks.
+ * @details The count is read until it is stable, so the value is not
+ * torn when the SysTick interrupt occurs while reading.
+ */
+unsigned int get_ticks(void)
+{
+	unsigned int _ticks;
+	do
+		_ticks = os.ticks;
+	while (_ticks != os.ticks);
+	return _ticks;
+};
+
+/**
+ * @brief Add the active time of one SysTick to the duty cycle.
+ * @param counts The timer counts from the start of the SysTick until the tasks were finished.
+ * @details The sum is halved when the window is full, so the duty cycle
+ * follows the recent load and the sum does not overflow.
+ */
+void count_busy(unsigned char counts)
+{
+	if (os.busy_ticks >= DUTY_WINDOW)
+	{
+		os.busy >>= 1;
+		os.busy_ticks >>= 1;
+	}
+	os.busy += counts;
+	os.busy_ticks++;
+};
+
+/**
+ * @brief Get the fraction of the time in which the tasks were active.
+ * @param counts_per_tick The timer counts of one SysTick.
+ * @return The duty cycle in 0.1 %.
+ */
+unsigned int get_duty_cycle(unsigned char counts_per_tick)
+{
+	unsigned long _total = (unsigned long)os.busy_ticks * counts_per_tick;
+	if (!_total)
+		return 0;
+	return (unsigned int)((os.busy * 1000) / _total);
+};
+
+/**
+ * @brief Reset the duty cycle measurement.
+ */
+void reset_duty_cycle(void)
+{
+	os.busy = 0;
+	os.busy_ticks = 0;
+};
+
+/**
+ * @brief Clear the loop overflow flag.
+ */
+void clear_overflow(void)
+{
+	os.loop_ovf = 0;
+};
+
+/**
+ * @brief Remember the start time of a task.
+ * @param task The number of the task(group).
+ * @param counter The timer register which counts from the start of the SysTick.
+ * The timer has to count in us, so one SysTick has tick_time counts.
+ * @details The timer and the tick count are read until the SysTick did not
+ * change in between, so both belong to the same SysTick.
+ */
+void begin_task(unsigned char task, volatile unsigned char* counter)
+{
+	do
+	{
+		os.exec[task].start_tick = os.ticks;
+		os.exec[task].start_count = *counter;
+	} while (os.exec[task].start_tick != os.ticks);
+};
+
+/**
+ * @brief Add the execution time of a task to its statistics.
+ * @param task The number of the task(group).
+ * @param counter The timer register which counts from the start of the SysTick.
+ */
+void end_task(unsigned char task, volatile unsigned char* counter)
+{
+	unsigned int _tick;
+	unsigned char _count;
+	do
+	{
+		_tick = os.ticks;
+		_count = *counter;
+	} while (_tick != os.ticks);
+
+	// Get the elapsed timer counts, saturated to 16 bit
+	unsigned long _time = (unsigned long)(unsigned int)(_tick - os.exec[task].start_tick) * os.tick_time;
+	_time += _count;
+	_time -= os.exec[task].start_count;
+	if (_time > 0xFFFF)
+		_time = 0xFFFF;
+
+	// Update the statistics, stop before the count overflows
+	volatile exectime_t* _exec = &os.exec[task];
+	if (_exec->count == 0xFFFF)
+		return;
+	if (!_exec->count || (_time < _exec->min))
+		_exec->min = (unsigned int)_time;
+	if (_time > _exec->max)
+		_exec->max = (unsigned int)_time;
+	_exec->sum += _time;
+	_exec->count++;
+};
+
+/**
+ * @brief Get the shortest execution time of a task.
+ * @param task The number of the task(group).
+ * @return The execution time in timer counts.
+ */
+unsigned int get_exec_min(unsigned char task)
+{
+	return os.exec[task].min;
+};
+
+/**
+ * @brief Get the longest execution time of a task.
+ * @param task The number of the task(group).
+ * @return The execution time in timer counts.
+ */
+unsigned int get_exec_max(unsigned char task)
+{
+	return os.exec[task].max;
+};
+
+/**
+ * @brief Get the mean execution time of a task.
+ * @param task The number of the task(group).
+ * @return The execution time in timer counts.
+ */
+unsigned int get_exec_mean(unsigned char task)
+{
+	if (!os.exec[task].count)
+		return 0;
+	return (unsigned int)(os.exec[task].sum / os.exec[task].count);
+};
+
+/**
+ * @brief Reset the execution time statistics of a task.
+ * @param task The number of the task(group).
+ */
+void reset_exec_time(unsigned char task)
+{
+	os.exec[task].min = 0;
+	os.exec[task].max = 0;
+	os.exec[task].sum = 0;
+	os.exec[task].count = 0;
+};
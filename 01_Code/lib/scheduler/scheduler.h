@@ -24,17 +24,42 @@
 // #include "system.h"
 
 //How many tasks do you want?
-#define NUM_TASKS	3
+#define NUM_TASKS	4
+
+//struct for the execution time of one task
+typedef struct
+{
+	unsigned int min;					//Shortest execution time in timer counts
+	unsigned int max;					//Longest execution time in timer counts
+	unsigned long sum;					//Sum of the execution times for the mean
+	unsigned int count;					//Number of measured executions
+	unsigned int start_tick;			//SysTick when the task was started
+	unsigned char start_count;			//Timer count when the task was started
+} exectime_t;
 
 //struct for task information
 typedef struct
 {
 	unsigned char tick_time;			//The scheduled periode of the SysTick timer.
-	unsigned char active[NUM_TASKS];	//Flag whether task should be executed at all
-	unsigned char flag[NUM_TASKS];		//Flag when task wants to run
-	unsigned int timer[NUM_TASKS];		//Timer for each task
+	unsigned char active;				//Bit mask of the tasks which should be executed at all
+	unsigned char ready;				//Bit mask toggled by the SysTick when a task wants to run
+	unsigned char taken;				//Bit mask toggled by run() when a task is started, ready ^ taken = waiting tasks
+	unsigned char periodic;				//Bit mask of the tasks which are started by their timer, the others only by events
+	unsigned char event;				//Bit mask of the events posted by the tasks, also waiting tasks
+	unsigned char tick_req;				//Bit mask toggled by post_tick() to start a task with the next SysTick
+	unsigned char tick_ack;				//Bit mask toggled by the SysTick when it signals the requested tasks
+	unsigned char head;					//The task which expires next, NO_TASK when no task is active
+	unsigned char next[NUM_TASKS];		//The task which expires after this one in the delta list
+	unsigned int delta[NUM_TASKS];		//SysTicks until the task expires, relative to the previous task in the delta list
 	unsigned int schedule[NUM_TASKS];	//Timer reload value of each task, determines the rate the tasks are executed
+	unsigned int pending[NUM_TASKS];	//Reload value which is applied by the SysTick, written by reschedule()
+	unsigned char resched_req;			//Bit mask toggled by reschedule() when a new reload value is pending
+	unsigned char resched_ack;			//Bit mask toggled by the SysTick when it applied the reload value
 	unsigned char loop_ovf;				//indicates when one task was started, when the loop time was already over
+	unsigned int ticks;					//Number of SysTicks since the start, used as a time stamp
+	unsigned long busy;					//Sum of the timer counts in which the tasks were active
+	unsigned int busy_ticks;			//Number of SysTicks in the busy sum
+	exectime_t exec[NUM_TASKS];			//Execution time of each task
 } schedule_t;
 
 //defines for task bits
@@ -47,12 +72,18 @@ typedef struct
 #define TASK6		6 // Taskgroup 6
 #define TASK7		7 // Taskgroup 7
 
+//Number of SysTicks after which the busy sum is halved, keeps busy * 1000 within 32 bit
+#define DUTY_WINDOW	16384
+
+//No task in the delta list
+#define NO_TASK		0xFF
+
 //State defines
 #define INACTIVE	0
 #define ACTIVE		1
 
 #if NUM_TASKS > 8
-#warning "Caution! You requested more tasks, than the scheduler is intended for!"
+#error "The scheduler uses 8-bit masks and can only handle 8 tasks!"
 #endif
 
 /*
@@ -60,14 +91,37 @@ typedef struct
  */
 
 void			scheduler_init		(unsigned char SysTick_us);
-void			schedule			(unsigned char task, unsigned int schedule);
+unsigned char	schedule			(unsigned char task, unsigned int schedule);
 void 			schedule_us			(unsigned char task, unsigned int schedule_us);
 void 			schedule_ms			(unsigned char task, unsigned int schedule_ms);
+void 			schedule_event		(unsigned char task);
+unsigned char 	reschedule			(unsigned char task, unsigned int schedule);
+void 			update_schedules	(void);
+unsigned int 	get_schedule		(unsigned char task);
+unsigned int 	get_timer			(unsigned char task);
 void 			set_task			(unsigned char task, unsigned char state);
 unsigned char 	get_task			(unsigned char task);
-void 			count_task			(unsigned char task);
+void 			insert_task			(unsigned char task, unsigned int timer);
+void 			remove_task			(unsigned char task);
 void 			run_scheduler		(void);
+void 			expire_tasks		(void);
 unsigned char 	run					(unsigned char task);
+unsigned char 	next_task			(void);
+void 			take_task			(unsigned char task);
+void 			post_event			(unsigned char task);
+void 			post_event_isr		(unsigned char task);
+void 			post_tick			(unsigned char task);
 unsigned char 	schedule_overflow	(void);
+unsigned int 	get_ticks			(void);
+void 			count_busy			(unsigned char counts);
+unsigned int 	get_duty_cycle		(unsigned char counts_per_tick);
+void 			reset_duty_cycle	(void);
+void 			clear_overflow		(void);
+void 			begin_task			(unsigned char task, volatile unsigned char* counter);
+void 			end_task			(unsigned char task, volatile unsigned char* counter);
+unsigned int 	get_exec_min		(unsigned char task);
+unsigned int 	get_exec_max		(unsigned char task);
+unsigned int 	get_exec_mean		(unsigned char task);
+void 			reset_exec_time		(unsigned char task);
 
 #endif /* SCHEDULER_H_ */
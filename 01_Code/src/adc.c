@@ -29,9 +29,53 @@
 // ****** Includes ******
 #include "adc.h"
 
+// The SysTick and the task periods are only known after all headers are included
+#if (ADC_SAMPLE_TICKS % ADC_OSR) != 0
+#error "The oversampling ratio has to divide the SysTicks of the sample period!"
+#endif
+
+#if ADC_OSR_BITS > 4
+#error "The PT1 filter has only 4 extra bits for the oversampling!"
+#endif
+
+#if ((ADC_BLOCK % ADC_OSR) != 0) || (ADC_BLOCK > 255)
+#error "The block has to contain a multiple of ADC_OSR samples!"
+#endif
+
+#if (ADC_OSR_TICKS < 1) || (ADC_OSR_TICKS > 255) || (ADC_OSR > 255)
+#error "The sample period of the ADC does not fit into the countdown!"
+#endif
+
+#if (ADC_SAMPLE_TCNT + ADC_SAMPLE_us) >= SYSTICK_us
+#error "The sample has to be finished before the next SysTick!"
+#endif
+
+// The native build has no ADC, the unit test changes the data line with the rising clock edge
+#ifndef ADC_CLOCK_EDGE
+#define ADC_CLOCK_EDGE()
+#endif
+
 // ****** Variables ******
 task_t taskADC;              // Task struct for task data
-IIR_Filter_t ADCFilter;   // The filter struct for the ADC data.
+/* Filter for ADC Data:
+ * - Type: Decimator + PT1
+ * - F_Sample: 100 Hz * ADC_OSR
+ * - Time Constant: 0.3 s
+ * The gain of the PT1 scales the sum of the decimator to 12 + ADC_OSR_BITS bits.
+ * ADC_OSR divides 50, so the gain in percent is exact. The extra bits of the
+ * samples replace extra bits of the calculation, the filter state keeps 16 bits.
+ * The coefficients are calculated at compile time.
+ */
+#define ADC_PT1_GAIN    ((100U << (ADC_OSR_BITS + DECIMATOR_SHIFT(ADC_OSR, 12))) / ADC_OSR)
+IIR_Filter_t ADCFilter = PT1_INIT(1000 / TASK1_ms, ADC_PT1_GAIN, 300, 12 + ADC_OSR_BITS, 4 - ADC_OSR_BITS); // The filter struct for the ADC data.
+Decimator_t adcDecimator = DECIMATOR_INIT(ADC_OSR, 12);   // Decimates the oversampled data
+unsigned int adcStamp;      // The SysTick of the last sample
+adcBlock_t adcBlock[2];                 // The double buffer of the samples
+volatile unsigned char adcBlockWrite;   // The block which is filled by the interrupt
+volatile unsigned char adcBlockIndex;   // The next sample in the filled block
+volatile unsigned char adcBlockReady;   // The other block is full and not filtered yet
+volatile unsigned char adcCountdown;    // SysTicks until the next sample
+volatile adcTiming_t adcTiming;         // Timing of the samples in the interrupt
 
 // ****** Functions ******
 
@@ -39,16 +83,43 @@ IIR_Filter_t ADCFilter;   // The filter struct for the ADC data.
  **********************************************************
  * @brief TASK ADC
  **********************************************************
- * Samples the external ADC.
+ * Filters the samples of the external ADC.
  * 
  **********************************************************
  * @details
+ * The samples are read in the compare match interrupt of
+ * TIMER0, so the sample instant does not depend on the other
+ * tasks. The interrupt collects ADC_BLOCK samples in one
+ * block of the double buffer and every full block starts this
+ * task with an event. The task decimates and filters the whole
+ * block in one pass and then releases it.
+ * The interrupt does not touch the block until it is released,
+ * so neither side has to disable the interrupts.
  * @Execution:	Non-interruptable
  **********************************************************
  */
 void Task_ADC(void)
 {
-    ApplyPT1(&ADCFilter, adc_Sample());
+    if (!adcBlockReady)
+        return;
+
+    // The interrupt fills the other block
+    adcBlock_t* _block = &adcBlock[adcBlockWrite ^ 1];
+    unsigned int _stamp = _block->stamp - (ADC_BLOCK - 1) * ADC_OSR_TICKS;
+
+    for (unsigned char sample = 0; sample < ADC_BLOCK; sample++)
+    {
+        if (ApplyDecimator(&adcDecimator, _block->sample[sample]))
+        {
+            ApplyPT1(&ADCFilter, GetDecimator(&adcDecimator));
+            adcStamp = _stamp;
+        }
+        _stamp += ADC_OSR_TICKS;
+    }
+
+    // Release the block
+    SYS_BARRIER();
+    adcBlockReady = 0;
 };
 
 /**
@@ -64,72 +135,185 @@ void adc_InitTask(void)
     DDRADC &= ~(1<<ADC_DATA);
     PORTADC |= (1<<ADC_CS);
 
-    /* Initialize Filter for ADC Data:
-     * - Type: PT1
-     * - F_Sample: 100 Hz
-     * - Time Constant: 0.5 s
-     */
-    CreatePT1(&ADCFilter, 100, 100, 300, 12, 4);
+    // Start the filters with an empty state
+    ResetDecimator(&adcDecimator);
+    ResetIIR(&ADCFilter);
+
+    // Sampling in the interrupt, the first sample is read with the first SysTick
+    adcCountdown = 1;
+    adcBlockWrite = 0;
+    adcBlockIndex = 0;
+    adcBlockReady = 0;
+    OCR0B = ADC_SAMPLE_TCNT;
+    adc_ResetTiming();
+};
+
+/**
+ * @brief Count the SysTicks until the next sample, called by the SysTick interrupt.
+ * @details The compare match interrupt is only enabled for the SysTick
+ * of the sample, so it does not cost any time in the other SysTicks.
+ */
+void adc_TickISR(void)
+{
+    if (--adcCountdown)
+        return;
+
+    adcCountdown = ADC_OSR_TICKS;
+    TIFR0 = (1<<OCF0B); // Forget the compare matches of the previous SysTicks
+    TIMSK0 |= (1<<OCIE0B);
 };
 
 /**
  * @brief Read a sample from the ADC.
+ * @details The ADC needs 3 clocks for the sampling and the null bit, then
+ * it shifts out the 12 data bits with the MSB first. Every bit is shifted into the
+ * accumulator right when it is read, so the 3 leading bits fall out of
+ * the 12-bit mask. On the AVR the 15 clocks are unrolled in assembler:
+ * Each bit takes 9 cycles, the clock is high for 5 and low for 4 cycles,
+ * independent of the value of the bit. At 8 MHz this is a 889 kHz clock
+ * and 135 cycles (17 us) for the whole sample.
  * @return The 12-bit value of the sampled voltage.
  */
 unsigned int adc_Sample(void)
 {
-    /*
-    * Buffer variable for result
-    * Each bit is stored in a char to achieve a consistent timing in the acquire for loop.
-    * -> the execution time of bitshifting is dependent on the amount of bits to shift.
-    */
-    unsigned char digitbuffer[15];
     unsigned int value = 0;
 
     // Activate the adc, CS Low, CLK low
     PORTADC &= ~(1<<ADC_CS);
     PORTADC &= ~(1<<ADC_CLK);
 
-    // Generate the clock and read all 12-bits
-    for (unsigned char tick = 15; tick > 0; tick--)
+#ifdef __AVR__
+    // Per bit: the skip of sbic takes as long as the executed sec, so the timing is constant
+    __asm__ __volatile__(
+        ".rept %[bits]"             "\n\t"
+        "sbi %[port], %[clk]"       "\n\t"    // 2: CLK High
+        "clc"                       "\n\t"    // 1
+        "sbic %[pin], %[data]"      "\n\t"    // 1 or 2: Sample input
+        "sec"                       "\n\t"    // 1 or 0
+        "cbi %[port], %[clk]"       "\n\t"    // 2: CLK Low
+        "rol %A[value]"             "\n\t"    // 1: Shift the bit in
+        "rol %B[value]"             "\n\t"    // 1
+        ".endr"
+        : [value] "+r" (value)
+        : [port] "I" (_SFR_IO_ADDR(PORTADC)),
+          [pin] "I" (_SFR_IO_ADDR(PINADC)),
+          [clk] "I" (ADC_CLK),
+          [data] "I" (ADC_DATA),
+          [bits] "M" (ADC_SAMPLE_BITS)
+    );
+#else
+    // Portable version with the same bit order
+    for (unsigned char tick = ADC_SAMPLE_BITS; tick > 0; tick--)
     {
-        // CLK High
         PORTADC |= (1<<ADC_CLK);
-        // Wait for a few CPU ticks
-        for (unsigned char wait = 0; wait < 1; wait++);
-        //Sample input
-        digitbuffer[tick-1] = (PINADC & (1<<ADC_DATA))>0;
-        // Clk Low
+        ADC_CLOCK_EDGE();
+        value = (value << 1) | ((PINADC >> ADC_DATA) & 1);
         PORTADC &= ~(1<<ADC_CLK);
-        // Wait for a few CPU ticks
-        for (unsigned char wait = 0; wait < 3; wait++);
     }
-    PORTADC |= (1<<ADC_CS);// | (1<<ADC_CLK);
-
-    // Translate the buffer to an actual integer result (unrolled loop):
-    // for (unsigned char tick = 0; tick < 12; tick++)
-    //     value += (buffer[tick] << tick);
-    value += digitbuffer[0]*1U;
-    value += digitbuffer[1]*2U;
-    value += digitbuffer[2]*4U;
-    value += digitbuffer[3]*8U;
-    value += digitbuffer[4]*16U;
-    value += digitbuffer[5]*32U;
-    value += digitbuffer[6]*64U;
-    value += digitbuffer[7]*128U;
-    value += digitbuffer[8]*256U;
-    value += digitbuffer[9]*512U;
-    value += digitbuffer[10]*1024U;
-    value += digitbuffer[11]*2048U;
-    
-    return value;
+#endif
+    PORTADC |= (1<<ADC_CS);
+
+    return value & 0x0FFF;
 };
 
 /**
  * @brief Read the current filtered adc value.
- * @return The current filtered value.
+ * @return The current filtered value with 12 bits.
  */
 unsigned int adc_GetValue(void)
+{
+    return GetIIR(&ADCFilter) >> ADC_OSR_BITS;
+};
+
+/**
+ * @brief Read the current filtered adc value with the resolution of the oversampling.
+ * @return The current filtered value with 12 + ADC_OSR_BITS bits.
+ */
+unsigned int adc_GetValueFine(void)
 {
     return GetIIR(&ADCFilter);
+};
+
+/**
+ * @brief Get the time stamp of the last sample.
+ * @return The SysTick when the last filtered sample was read.
+ */
+unsigned int adc_GetStamp(void)
+{
+    return adcStamp;
+};
+
+/**
+ * @brief Get the jitter of the sample instant.
+ * @return The difference between the latest and the earliest start
+ * of a sample in timer counts (us).
+ */
+unsigned char adc_GetJitter(void)
+{
+    if (adcTiming.max < adcTiming.min)
+        return 0;
+    return adcTiming.max - adcTiming.min;
+};
+
+/**
+ * @brief Get the timing of the samples.
+ * @return The pointer to the timing data.
+ */
+adcTiming_t* adc_GetTiming(void)
+{
+    return (adcTiming_t*)&adcTiming;
+};
+
+/**
+ * @brief Reset the timing of the samples.
+ */
+void adc_ResetTiming(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        adcTiming.min = 0xFF;
+        adcTiming.max = 0;
+        adcTiming.overrun = 0;
+    }
+};
+
+//****** Interrupts ******
+/**
+ * @brief Compare match B of TIMER0, reads one sample of the ADC.
+ * @details The interrupt is enabled by adc_TickISR() for one SysTick.
+ * The sample takes less than ADC_SAMPLE_us, so it is finished before
+ * the next SysTick. The sample is stored in the block of the double
+ * buffer and every full block is handed to the filter task.
+ */
+ISR(TIMER0_COMPB_vect)
+{
+    unsigned char _count = TCNT0;
+    TIMSK0 &= ~(1<<OCIE0B);
+
+    // Record the sample instant
+    if (_count < adcTiming.min)
+        adcTiming.min = _count;
+    if (_count > adcTiming.max)
+        adcTiming.max = _count;
+
+    // Read the sample into the block
+    adcBlock_t* _block = &adcBlock[adcBlockWrite];
+    _block->sample[adcBlockIndex] = adc_Sample();
+    if (++adcBlockIndex < ADC_BLOCK)
+        return;
+    adcBlockIndex = 0;
+
+    // The task still filters the other block, drop this one and fill it again
+    if (adcBlockReady)
+    {
+        if (adcTiming.overrun < 0xFF)
+            adcTiming.overrun++;
+        return;
+    }
+
+    // Hand the full block to the filter task
+    _block->stamp = get_ticks();
+    adcBlockWrite ^= 1;
+    adcBlockReady = 1;
+    post_event_isr(ADC_TASK);
 };
\ No newline at end of file
@@ -28,12 +28,23 @@
  */
 // ****** Includes ******
 #include "disp.h"
-#include "font.h"
-#include "digit.h"
+#include "oScale.h"
+#include "glyph.h"
+#include <string.h>
 
 // ****** Variables ******
 task_t taskDisp;    // Task data for display
 dispDat_t datDisp;  // Content data for display
+dispQueue_t queueDisp; // Queue of the display commands
+#if DISP_SHADOW_PAGES
+unsigned char shadowDisp[DISP_SHADOW_PAGES][DISP_SIZE_COL]; // Shadow of the display RAM
+#endif
+#if DISP_SPI_ISR
+dispTx_t dispTx;    // Transmit buffer for the SPI interrupt
+#endif
+#if DISP_LATENCY
+dispLatency_t latencyDisp; // Latency of the time stamped commands
+#endif
 
 
 // ****** Functions ******
@@ -104,6 +115,43 @@ inline void disp_SetRSTLow(void)
  */
 void Task_Disp(void)
 {
+#if DISP_SPI_ISR
+    /*
+     * Run the command sequences until the transmit buffer is full,
+     * the command has to wait or the step limit is reached.
+     * The SPI interrupt then sends the buffered bytes in the background.
+     */
+    unsigned char _steps = DISP_STEPS_PER_TICK;
+    do
+        disp_RunCommand();
+    while (disp_IsBusy() && !taskDisp.wait && disp_TxFree() && --_steps);
+#else
+    /*
+     * Send the bytes in a burst, a step which finds the SPI busy is repeated.
+     * The burst stops when the step budget is used or TCNT0 of the SysTick reaches
+     * the time budget, so the other tasks of the tick still get their time.
+     */
+    unsigned char _steps = DISP_BURST_STEPS;
+    do
+        disp_RunCommand();
+    while (disp_IsBusy() && !taskDisp.wait && --_steps && (TCNT0 < DISP_BURST_TCNT));
+#endif
+
+    // Continue with the next SysTick, the task sleeps when all commands are done
+    if (disp_IsBusy())
+        post_tick(DISP_TASK);
+};
+
+/**
+ * @brief Perform one step of the active display command.
+ */
+void disp_RunCommand(void)
+{
+    // Start the next queued command when no command is active
+    if (taskDisp.command == 0)
+        if (!disp_QueueNext())
+            return;
+
     // Switch for active command
     switch (taskDisp.command)
     {
@@ -115,6 +163,10 @@ void Task_Disp(void)
         disp_Clear();
         break;
 
+    case DISP_CMD_FILL_RECT:
+        disp_FillRect();
+        break;
+
     case DISP_CMD_LINE_H:
         disp_WriteHorizontalLine();
         break;
@@ -139,14 +191,32 @@ void Task_Disp(void)
         disp_WriteNumber();
         break;
 
+    case DISP_CMD_BLIT_STRING:
+    case DISP_CMD_BLIT_NUMBER:
+        disp_BlitString();
+        break;
+
+    case DISP_CMD_PLOT_COLUMN:
+        disp_PlotColumn();
+        break;
+
     default:
         break;
     }
+
+#if DISP_LATENCY
+    // The bytes of a finished command are in the transmit buffer now
+    if (!taskDisp.command && datDisp.stamped)
+    {
+        disp_RecordLatency(get_ticks() - datDisp.stamp);
+        datDisp.stamped = 0;
+    }
+#endif
 };
 
 /**
  * @brief Initialize the task data of the display.
- * @param us_per_tick The schedule of the task as set in the scheduler.
+ * @param us_per_tick The time between two calls of the task while it is busy.
  */
 void disp_InitTask(unsigned int us_per_tick)
 {
@@ -158,6 +228,27 @@ void disp_InitTask(unsigned int us_per_tick)
     // Display data
     datDisp.x = 8;
     datDisp.y = 0;
+    datDisp.pattern = 0;
+    datDisp.column = 0;
+    datDisp.page = 0xFF; // Unknown until the first page address is sent
+    datDisp.stamped = 0;
+
+    // Command queue
+    queueDisp.head = 0;
+    queueDisp.tail = 0;
+    queueDisp.x    = datDisp.x;
+    queueDisp.y    = datDisp.y;
+    queueDisp.stamped = 0;
+#if DISP_LATENCY
+    disp_ResetLatency();
+#endif
+
+#if DISP_SPI_ISR
+    // Transmit buffer
+    dispTx.head   = 0;
+    dispTx.tail   = 0;
+    dispTx.active = 0;
+#endif
 };
 
 /**
@@ -177,6 +268,9 @@ void disp_Init(void)
 
         // Initialize the SPI
         SPCR = (1 << SPE) | (1 << MSTR) | (1 << CPOL) | (1 << CPHA) | (1 << SPR0);
+#if DISP_SPI_ISR
+        SPCR |= (1 << SPIE);
+#endif
 
         // Set wait for 1 ms before continuing with the task
         taskDisp.wait = 1000 / taskDisp.schedule;
@@ -197,8 +291,13 @@ void disp_Init(void)
     case 2:
         disp_SetCSLow();
         // Set the display start line to 0
+#if DISP_SPI_ISR
+        if (disp_SendCommand(DISP_CTRL_START))
+            taskDisp.sequence++;
+#else
         SPDR = DISP_CTRL_START;
         taskDisp.sequence++;
+#endif
         break;
 
     case 3:
@@ -291,14 +390,21 @@ void disp_Init(void)
 
 /**
  * @brief Send a byte to the display.
+ * The A0 pin is only switched when the SPI is idle, the display samples A0
+ * with the last bit of the byte which is still shifting out otherwise.
  * @param data The data for the display.
+ * @param a0 The state of the A0 pin while the byte is sent. (0: command, 1: data)
  * @return Returns one when the data was written to the data register of the SPI.
  */
-unsigned char disp_SendByte(unsigned char data)
+unsigned char disp_SendByte(unsigned char data, unsigned char a0)
 {
     // Only send data, when SPI is not busy
     if (SPSR & (1<<SPIF))
     {
+        if (a0)
+            disp_SetA0High();
+        else
+            disp_SetA0Low();
         SPDR = data;
         return 1;
     }
@@ -313,8 +419,16 @@ unsigned char disp_SendByte(unsigned char data)
  */
 unsigned char disp_SendCommand(unsigned char command)
 {
-    disp_SetA0Low();
-    return disp_SendByte(command);
+#if DISP_SPI_ISR
+    if (!disp_TxPush(command, 0))
+        return 0;
+#else
+    if (!disp_SendByte(command, 0))
+        return 0;
+#endif
+    // Keep track of the RAM address of the display
+    disp_TrackAddress(command);
+    return 1;
 };
 
 /**
@@ -324,83 +438,295 @@ unsigned char disp_SendCommand(unsigned char command)
  */
 unsigned char disp_SendData(unsigned char data)
 {
-    disp_SetA0High();
-    return disp_SendByte(data);
+#if DISP_SPI_ISR
+    if (!disp_TxPush(data, 1))
+        return 0;
+#else
+    if (!disp_SendByte(data, 1))
+        return 0;
+#endif
+#if DISP_SHADOW_PAGES
+    // Keep the shadow up to date
+    unsigned char _page = datDisp.page - DISP_SHADOW_PAGE;
+    if ((_page < DISP_SHADOW_PAGES) && (datDisp.column < DISP_SIZE_COL))
+        shadowDisp[_page][datDisp.column] = data;
+#endif
+    // The display increments the column address after every data byte
+    datDisp.column++;
+    return 1;
 };
 
+/**
+ * @brief Update the RAM address of the display according to a sent command.
+ * @param command The command which was sent to the display.
+ * @details The payload bytes of the init commands are also interpreted as
+ * column addresses, but every write sets its address before writing anyway.
+ */
+void disp_TrackAddress(unsigned char command)
+{
+    switch (command & 0xF0)
+    {
+    case DISP_CTRL_COL_H:
+        datDisp.column = (datDisp.column & 0x0F) | (command << 4);
+        break;
+
+    case DISP_CTRL_COL_L:
+        datDisp.column = (datDisp.column & 0xF0) | (command & 0x0F);
+        break;
+
+    case DISP_CTRL_PAGE:
+        datDisp.page = command & 0x0F;
+        break;
+
+    default:
+        break;
+    }
+};
+
+/**
+ * @brief Check whether the display RAM already contains the data.
+ * @param page The page of the data.
+ * @param column The column of the data.
+ * @param data The data byte which should be written.
+ * @return Returns 1 when the shadow of the display RAM contains the same data.
+ * Outside of the shadow region the data is never equal.
+ */
+unsigned char disp_ShadowEqual(unsigned char page, unsigned char column, unsigned char data)
+{
+#if DISP_SHADOW_PAGES
+    unsigned char _page = page - DISP_SHADOW_PAGE;
+    if ((_page < DISP_SHADOW_PAGES) && (column < DISP_SIZE_COL))
+        return (shadowDisp[_page][column] == data);
+#endif
+    return 0;
+};
+
+#if DISP_SPI_ISR
+/**
+ * @brief Put a byte into the transmit buffer of the SPI interrupt.
+ * Starts the transmission when the SPI is idle.
+ * @param data The byte for the display.
+ * @param a0 The state of the A0 pin while the byte is sent. (0: command, 1: data)
+ * @return Returns one when the byte was put into the transmit buffer.
+ */
+unsigned char disp_TxPush(unsigned char data, unsigned char a0)
+{
+    // Only queue the byte when there is space left
+    if (!disp_TxFree())
+        return 0;
+
+    // Write the byte, the ISR only sees it after the head is updated
+    unsigned char _index = dispTx.head & (DISP_TX_SIZE - 1);
+    dispTx.data[_index] = data;
+    dispTx.a0[_index]   = a0;
+
+    // Publish the byte, the stores above must not move past the head
+    SYS_BARRIER();
+    dispTx.head++;
+
+    // Start the transmission when the SPI is idle
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (!dispTx.active)
+            disp_TxNext();
+    }
+    return 1;
+};
+
+/**
+ * @brief Get the number of free bytes in the transmit buffer.
+ * @return The number of bytes which can be queued.
+ */
+unsigned char disp_TxFree(void)
+{
+    return DISP_TX_SIZE - (unsigned char)(dispTx.head - dispTx.tail);
+};
+
+/**
+ * @brief Send the next byte of the transmit buffer.
+ * The A0 pin is switched before the byte is written to the SPI, at this point
+ * the previous byte is already shifted out completely.
+ * @details Has to be called with interrupts disabled.
+ */
+void disp_TxNext(void)
+{
+    if (dispTx.head != dispTx.tail)
+    {
+        unsigned char _index = dispTx.tail & (DISP_TX_SIZE - 1);
+        if (dispTx.a0[_index])
+            disp_SetA0High();
+        else
+            disp_SetA0Low();
+        SPDR = dispTx.data[_index];
+        dispTx.tail++;
+        dispTx.active = 1;
+    }
+    else
+        dispTx.active = 0;
+};
+#endif
+
 /**
  * @brief Check whether the task is busy sending data to the display.
- * @return Returns one when the task is busy.
+ * @return Returns one when a command is active or queued.
  */
 unsigned char disp_IsBusy(void)
 {
-    return (taskDisp.command != 0);
+    return (taskDisp.command != 0) || (queueDisp.head != queueDisp.tail);
+};
+
+/**
+ * @brief Get the number of free slots in the command queue.
+ * @return The number of commands which can be queued.
+ */
+unsigned char disp_QueueFree(void)
+{
+    return DISP_QUEUE_SIZE - (unsigned char)(queueDisp.head - queueDisp.tail);
+};
+
+/**
+ * @brief Reserve the next slot of the command queue.
+ * The cursor which is currently set is saved with the command.
+ * @param cmd The command to queue.
+ * @return The pointer to the queued command, so the arguments can be set.
+ * Returns 0 when the queue is full.
+ */
+dispCall_t* disp_QueuePush(unsigned char cmd)
+{
+    // Only queue the command when there is space left
+    if (!disp_QueueFree())
+        return 0;
+
+    // Set the commands data
+    dispCall_t* _call = &queueDisp.call[queueDisp.head & (DISP_QUEUE_SIZE - 1)];
+    _call->command     = cmd;
+    _call->argument[0] = 0;
+    _call->argument[1] = 0;
+    _call->argument[2] = 0;
+    _call->x           = queueDisp.x;
+    _call->y           = queueDisp.y;
+    _call->string      = 0;
+    _call->pattern     = 0;
+    _call->stamp       = queueDisp.stamp;
+    _call->stamped     = queueDisp.stamped;
+    queueDisp.stamped  = 0;
+    queueDisp.head++;
+
+    // Wake up the display task
+    post_event(DISP_TASK);
+    return _call;
+};
+
+/**
+ * @brief Start the next command of the command queue.
+ * @return Returns 1 when a command was started.
+ */
+unsigned char disp_QueueNext(void)
+{
+    // Check whether there is a queued command
+    if (queueDisp.head == queueDisp.tail)
+        return 0;
+
+    // Load the command data to the task
+    dispCall_t* _call = &queueDisp.call[queueDisp.tail & (DISP_QUEUE_SIZE - 1)];
+    taskDisp.argument[0] = _call->argument[0];
+    taskDisp.argument[1] = _call->argument[1];
+    taskDisp.argument[2] = _call->argument[2];
+    taskDisp.command     = _call->command;
+    taskDisp.sequence    = 0;
+    datDisp.x            = _call->x;
+    datDisp.y            = _call->y;
+    datDisp.string       = _call->string;
+    datDisp.pattern      = _call->pattern;
+    datDisp.stamp        = _call->stamp;
+    datDisp.stamped      = _call->stamped;
+    queueDisp.tail++;
+    return 1;
 };
 
 /**
  * @brief Clear the content of the display.
+ * @details The whole display RAM is filled with blank data
+ * by continuing with the command DISP_CMD_FILL_RECT.
  */
 void disp_Clear(void)
 {
-    // Switch the command sequence
+    // Fill all pages and columns with blank data
+    taskDisp.argument[0] = DISP_SIZE_PAGE - 1;
+    taskDisp.argument[1] = 0;
+    taskDisp.argument[2] = DISP_SIZE_COL;
+    datDisp.pattern      = 0x00;
+    taskDisp.command     = DISP_CMD_FILL_RECT;
+    taskDisp.sequence    = 0;
+};
+
+/**
+ * @brief Fill a rectangle of the display RAM with a constant byte.
+ * @details Every page is written with one address setup, then the
+ * pattern is streamed until the end column.
+ * @param arg[0] The first page in the upper and the last page in the lower nibble.
+ * @param arg[1] The start column.
+ * @param arg[2] The end column, which is not written anymore.
+ * @param pattern The byte which is written to every column.
+ */
+void disp_FillRect(void)
+{
+    // Get the rectangle parameters
+    unsigned char *pages   = taskDisp.argument;
+    unsigned char *x_start = taskDisp.argument + 1;
+    unsigned char *x_end   = taskDisp.argument + 2;
+
+    // Perform the command sequence
     switch (taskDisp.sequence)
     {
-    case 0:
-        // Set the first page to zero
-        taskDisp.argument[0] = 0;
-
-    case 1:
-        // Set the MSB of the column address
-        if (disp_SendCommand(DISP_CTRL_COL_H))
-            taskDisp.sequence++;
-        break;
+        case 0:
+            // Set the page address
+            if (disp_SendCommand(DISP_CTRL_PAGE + (*pages >> 4)))
+                taskDisp.sequence++;
+            break;
 
-    case 2:
-        // Set the LSB of the column address
-        if (disp_SendCommand(DISP_CTRL_COL_L))
-            taskDisp.sequence++;
-        break;
+        case 1:
+            // Set the column address high
+            if (disp_SendCommand(DISP_CTRL_COL_H | (*x_start >> 4)))
+                taskDisp.sequence++;
+            break;
 
-    case 3:
-        // Set the Page Address
-        if (disp_SendCommand(DISP_CTRL_PAGE + taskDisp.argument[0]))
-        {
-            //Set counter to count every written column
-            taskDisp.counter = 128;
-            taskDisp.sequence++;
-        }
-        break;
+        case 2:
+            // Set the column address low
+            if (disp_SendCommand(DISP_CTRL_COL_L | (*x_start & 0xF)))
+            {
+                // Set the counter for the columns to be written
+                taskDisp.counter = *x_end - *x_start;
+                taskDisp.sequence++;
+            }
+            break;
 
-    case 4:
-        // Write blank data until one page is written
-        if (taskDisp.counter)
-        {
-            if( disp_SendData(0x00) )
-                taskDisp.counter--;
-        }
-        else
-        {
-            //check whether all pages are written
-            if (taskDisp.argument[0] < 7)
+        case 3:
+            // Stream the pattern until the page is written
+            if (taskDisp.counter)
             {
-                // write next bank
-                taskDisp.argument[0]++;
-                taskDisp.sequence = 1;
+                if (disp_SendData(datDisp.pattern))
+                    taskDisp.counter--;
             }
             else
             {
-                //All pages are written, exit the command
-                taskDisp.argument[0] = 0;
-                taskDisp.argument[1] = 0;
-                taskDisp.argument[2] = 0;
-                taskDisp.sequence    = 0;
-                taskDisp.command     = 0;
+                // Check whether all pages are written
+                if ((*pages >> 4) < (*pages & 0x0F))
+                {
+                    // Write the next page
+                    *pages += 0x10;
+                    taskDisp.sequence = 0;
+                }
+                else
+                {
+                    // All pages are written, exit the command
+                    sarb_return(&taskDisp);
+                }
             }
-        }
-        break;
-        
-    default:
-        break;
+            break;
+
+        default:
+            break;
     }
 };
 
@@ -528,6 +854,104 @@ void disp_WriteVerticalLine(void)
     }
 };
 
+/**
+ * @brief Plot one sample column of a strip chart.
+ * @details The column left of the sample is cleared, so the chart is
+ * swept across the screen with a gap in front of the newest sample.
+ * Both columns are written with one address per page, the column
+ * address increments from the gap to the sample column.
+ * @param arg[0] The RAM column of the sample, the gap is at column - 1.
+ * @param arg[1] The first page in the upper and the last page in the lower nibble.
+ * @param arg[2] The highest pixel in the upper and the lowest pixel in the lower nibble,
+ * counted from the bottom of the last page. DISP_PLOT_BLANK clears the column.
+ */
+void disp_PlotColumn(void)
+{
+    // Get the plot parameters
+    unsigned char *x     = taskDisp.argument;
+    unsigned char *pages = taskDisp.argument + 1;
+
+    // Perform the command sequence
+    switch (taskDisp.sequence)
+    {
+        case 0:
+            // Start with the first page
+            taskDisp.counter = *pages >> 4;
+
+            // Goto next sequence
+            taskDisp.sequence++;
+
+        case 1:
+            // Set the column address high of the gap
+            if (disp_SendCommand(DISP_CTRL_COL_H | ((*x - 1) >> 4)))
+                taskDisp.sequence++;
+            break;
+
+        case 2:
+            // Set the column address low of the gap
+            if (disp_SendCommand(DISP_CTRL_COL_L | ((*x - 1) & 0xF)))
+                taskDisp.sequence++;
+            break;
+
+        case 3:
+            // Set the page address
+            if (disp_SendCommand(DISP_CTRL_PAGE + taskDisp.counter))
+                taskDisp.sequence++;
+            break;
+
+        case 4:
+            // Clear the gap
+            if (disp_SendData(0x00))
+                taskDisp.sequence++;
+            break;
+
+        case 5:
+            // Write the sample
+            if (disp_SendData(disp_GetPlotByte()))
+            {
+                // Check whether all pages are written
+                if (taskDisp.counter < (*pages & 0x0F))
+                {
+                    // Write the next page
+                    taskDisp.counter++;
+                    taskDisp.sequence = 1;
+                }
+                else
+                {
+                    // All pages are written, exit command
+                    sarb_return(&taskDisp);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+};
+
+/**
+ * @brief Get the display byte of the current page of a plotted column.
+ * @details The pixels are counted from the bottom of the last page
+ * and bit 0 is the top row of a page.
+ * @return The byte with the pixels of the sample in the current page.
+ */
+unsigned char disp_GetPlotByte(void)
+{
+    // Pixel range of the sample and the current page
+    unsigned char _high = taskDisp.argument[2] >> 4;
+    unsigned char _low  = taskDisp.argument[2] & 0x0F;
+    unsigned char _bottom = ((taskDisp.argument[1] & 0x0F) - (unsigned char)taskDisp.counter) * 8;
+    unsigned char _data = 0;
+
+    // Set the bits of all pixels within the range
+    for (unsigned char _row = 0; _row < 8; _row++)
+    {
+        if ((_bottom + _row >= _low) && (_bottom + _row <= _high))
+            _data |= (1<<(7 - _row));
+    }
+    return _data;
+};
+
 /**
  * @brief Write a single character at the cursor position
  * @param arg[0] The character to be displayed.
@@ -565,7 +989,7 @@ void disp_WriteChar(void)
         
         case 4:
             // Send data
-            if (disp_SendData(font[*character][taskDisp.counter]))
+            if (disp_SendData(disp_GetCharGlyph(*character)[FONT_X - 1 - taskDisp.counter]))
             {
                 if (taskDisp.counter)
                     taskDisp.counter--;
@@ -596,12 +1020,20 @@ void disp_WriteChar(void)
 
 /**
  * @brief Write a single digit with the digit font to the display RAM.
+ * Columns which are already on the display are skipped, the address is only
+ * set at the start of a run of changed columns.
  * @param arg[0] The digit to be displayed.
+ * @details arg[1] is used as a buffer for the current row of the digit.
  */
 void disp_WriteDigit(void)
 {
-    // Get the digit to display
+    // Get the digit to display and the row of the digit which is written
     unsigned char *digit = taskDisp.argument;
+    unsigned char *row   = taskDisp.argument + 1;
+
+    // Get the position of the current column
+    unsigned char _page   = datDisp.y + 1 - *row;
+    unsigned char _column = datDisp.x + (DIGIT_X - 1) - taskDisp.counter;
 
     // Perform the command sequences
     switch (taskDisp.sequence)
@@ -609,60 +1041,39 @@ void disp_WriteDigit(void)
         case 0:
             //Set the counter according to the font size
             taskDisp.counter = DIGIT_X-1;
-            taskDisp.wait = 0;
+            *row = 0;
             taskDisp.sequence++;
+            break;
 
         case 1:
+            // Skip the columns which are already on the display
+            disp_SeekDigitColumn();
+            break;
+
+        case 2:
             // Set the column address H
-            if (disp_SendCommand(DISP_CTRL_COL_H | (datDisp.x >> 4)))
+            if (disp_SendCommand(DISP_CTRL_COL_H | (_column >> 4)))
                 taskDisp.sequence++;
             break;
 
-        case 2:
+        case 3:
             // Set the column address L
-            if (disp_SendCommand(DISP_CTRL_COL_L | (datDisp.x & 0xF)))
+            if (disp_SendCommand(DISP_CTRL_COL_L | (_column & 0xF)))
                 taskDisp.sequence++;
             break;
 
-        case 3:
+        case 4:
             // Set the page address
-            if (disp_SendCommand(DISP_CTRL_PAGE + datDisp.y + 1 - taskDisp.wait))
+            if (disp_SendCommand(DISP_CTRL_PAGE + _page))
                 taskDisp.sequence++;
             break;
         
-        case 4:
+        case 5:
             // Send data
-            if (disp_SendData(number[*digit][ (2*taskDisp.counter) + taskDisp.wait]))
+            if (disp_SendData(glyph_digit[*digit][*row][DIGIT_X - 1 - taskDisp.counter]))
             {
-                if (taskDisp.counter)
-                    taskDisp.counter--;
-                else
-                {
-                    // First row finished, goto second row
-                    if (taskDisp.wait == 0)
-                    {
-                        taskDisp.counter = DIGIT_X-1;
-                        taskDisp.wait = 1;
-                        taskDisp.sequence = 1;
-                    }
-                    else
-                    {
-                        //Command finished, increase cursor
-                        if (datDisp.x >= DIGIT_X)
-                            datDisp.x -= DIGIT_X;
-                        else
-                        {
-                            datDisp.x = DISP_SIZE_COL - 1;
-                            if (datDisp.y < (DISP_SIZE_PAGE - 2))
-                                datDisp.y += 2;
-                            else
-                                datDisp.y = 0;
-                        }
-
-                        // Exit the command
-                        sarb_return(&taskDisp);
-                    }
-                }
+                if (disp_NextDigitColumn())
+                    disp_SeekDigitColumn();
             }
             break;
 
@@ -671,6 +1082,75 @@ void disp_WriteDigit(void)
     }
 };
 
+/**
+ * @brief Skip the columns of the digit which are already on the display and
+ * decide whether the address has to be set for the next column.
+ */
+void disp_SeekDigitColumn(void)
+{
+    // Get the digit to display and the row of the digit which is written
+    unsigned char *digit = taskDisp.argument;
+    unsigned char *row   = taskDisp.argument + 1;
+
+    // Get the position of the current column
+    unsigned char _page   = datDisp.y + 1 - *row;
+    unsigned char _column = datDisp.x + (DIGIT_X - 1) - taskDisp.counter;
+
+    // Skip the columns which are already on the display
+    while (disp_ShadowEqual(_page, _column, glyph_digit[*digit][*row][DIGIT_X - 1 - taskDisp.counter]))
+    {
+        if (!disp_NextDigitColumn())
+            return;
+        _page   = datDisp.y + 1 - *row;
+        _column = datDisp.x + (DIGIT_X - 1) - taskDisp.counter;
+    }
+
+    // Only set the address when the display is not already there
+    if ((_page == datDisp.page) && (_column == datDisp.column))
+        taskDisp.sequence = 5;
+    else
+        taskDisp.sequence = 2;
+};
+
+/**
+ * @brief Go to the next column of the digit which is written.
+ * When the digit is finished the cursor is moved and the command exits.
+ * @return Returns 1 when there are columns left to write.
+ */
+unsigned char disp_NextDigitColumn(void)
+{
+    // Get the row of the digit which is written
+    unsigned char *row = taskDisp.argument + 1;
+
+    if (taskDisp.counter)
+        taskDisp.counter--;
+    else if (*row == 0)
+    {
+        // First row finished, goto second row
+        taskDisp.counter = DIGIT_X-1;
+        *row = 1;
+    }
+    else
+    {
+        //Command finished, increase cursor
+        if (datDisp.x >= DIGIT_X)
+            datDisp.x -= DIGIT_X;
+        else
+        {
+            datDisp.x = DISP_SIZE_COL - 1;
+            if (datDisp.y < (DISP_SIZE_PAGE - 2))
+                datDisp.y += 2;
+            else
+                datDisp.y = 0;
+        }
+
+        // Exit the command
+        sarb_return(&taskDisp);
+        return 0;
+    }
+    return 1;
+};
+
 /**
  * @brief Write string of characters to the display.
  *        The string has to be terminated with \0 !
@@ -711,7 +1191,7 @@ void disp_WriteNumber(void)
     {
     case 0:
         // Write the current digit to the display
-        taskDisp.argument[0] = *datDisp.string - 0x2c;
+        taskDisp.argument[0] = *datDisp.string - GLYPH_DIGIT_FIRST;
         sarb_GoSub(&taskDisp, DISP_CMD_WRITE_DIGIT);
         break;
 
@@ -728,21 +1208,227 @@ void disp_WriteNumber(void)
 };
 
 /**
- * @brief Set the x direction of the cursor.
+ * @brief Stream a string to the display with one address per page.
+ *        The string has to be terminated with \0 and has to fit into the line!
+ * @details The display is mounted with the reversed column mapping, the string
+ * is written from the right to the left in the RAM. So the string is streamed
+ * starting with the last glyph and the columns of each glyph are reversed, then
+ * the column auto increment of the display matches the stream. Columns which
+ * are already on the display are skipped, the address is set again after them.
+ * - DISP_CMD_BLIT_STRING uses the character font.
+ * - DISP_CMD_BLIT_NUMBER uses the digit font with two pages.
+ * - arg[0] is used as a buffer for the current row of the glyphs.
+ * - arg[1] is used as a buffer for the number of glyphs.
+ * - arg[2] is used as a buffer for the current column of the glyph.
+ * - counter is the current column of the stream.
+ */
+void disp_BlitString(void)
+{
+    // Get the stream parameters
+    unsigned char *row       = taskDisp.argument;
+    unsigned char *length    = taskDisp.argument + 1;
+    unsigned char *glyph_col = taskDisp.argument + 2;
+    unsigned char _digits    = (taskDisp.command == DISP_CMD_BLIT_NUMBER);
+    unsigned char _width     = _digits ? DIGIT_X : FONT_X;
+
+    // Get the position of the current column
+    unsigned char _page   = datDisp.y + _digits - *row;
+    unsigned char _column = datDisp.x + taskDisp.counter;
+
+    // Perform the command sequences
+    switch (taskDisp.sequence)
+    {
+        case 0:
+            // Get the number of glyphs which fit into the line
+            *length = strlen(datDisp.string);
+            if (*length > (datDisp.x / _width) + 1)
+                *length = (datDisp.x / _width) + 1;
+            if (*length == 0)
+            {
+                sarb_return(&taskDisp);
+                break;
+            }
+
+            // The stream starts at the column of the last glyph
+            datDisp.x -= (*length - 1) * _width;
+            datDisp.string += *length - 1;
+            *row = 0;
+            *glyph_col = _width - 1;
+            taskDisp.counter = 0;
+            disp_LoadBlitGlyph();
+            taskDisp.sequence++;
+            break;
+
+        case 1:
+            // Skip the columns which are already on the display
+            disp_SeekBlitColumn();
+            break;
+
+        case 2:
+            // Set the column address H
+            if (disp_SendCommand(DISP_CTRL_COL_H | (_column >> 4)))
+                taskDisp.sequence++;
+            break;
+
+        case 3:
+            // Set the column address L
+            if (disp_SendCommand(DISP_CTRL_COL_L | (_column & 0xF)))
+                taskDisp.sequence++;
+            break;
+
+        case 4:
+            // Set the page address
+            if (disp_SendCommand(DISP_CTRL_PAGE + _page))
+                taskDisp.sequence++;
+            break;
+
+        case 5:
+            // Stream the data
+            if (disp_SendData(*datDisp.glyph))
+            {
+                if (disp_NextBlitColumn())
+                    disp_SeekBlitColumn();
+            }
+            break;
+
+        default:
+            break;
+    }
+};
+
+/**
+ * @brief Skip the columns of the string which are already on the display and
+ * decide whether the address has to be set for the next column.
+ */
+void disp_SeekBlitColumn(void)
+{
+    // Get the stream parameters
+    unsigned char *row    = taskDisp.argument;
+    unsigned char _digits = (taskDisp.command == DISP_CMD_BLIT_NUMBER);
+
+    // Get the position of the current column
+    unsigned char _page   = datDisp.y + _digits - *row;
+    unsigned char _column = datDisp.x + taskDisp.counter;
+
+    // Skip the columns which are already on the display
+    while (disp_ShadowEqual(_page, _column, *datDisp.glyph))
+    {
+        if (!disp_NextBlitColumn())
+            return;
+        _page   = datDisp.y + _digits - *row;
+        _column = datDisp.x + taskDisp.counter;
+    }
+
+    // Only set the address when the display is not already there
+    if ((_page == datDisp.page) && (_column == datDisp.column))
+        taskDisp.sequence = 5;
+    else
+        taskDisp.sequence = 2;
+};
+
+/**
+ * @brief Load the glyph of the current character of the string which is streamed.
+ */
+void disp_LoadBlitGlyph(void)
+{
+    // Get the row of the glyphs
+    unsigned char *row = taskDisp.argument;
+
+    if (taskDisp.command == DISP_CMD_BLIT_NUMBER)
+        datDisp.glyph = glyph_digit[*datDisp.string - GLYPH_DIGIT_FIRST][*row];
+    else
+        datDisp.glyph = disp_GetCharGlyph(*datDisp.string);
+};
+
+/**
+ * @brief Go to the next column of the string which is streamed.
+ * When all pages are finished the cursor is moved and the command exits.
+ * @return Returns 1 when there are columns left to write.
+ */
+unsigned char disp_NextBlitColumn(void)
+{
+    // Get the stream parameters
+    unsigned char *row       = taskDisp.argument;
+    unsigned char *length    = taskDisp.argument + 1;
+    unsigned char *glyph_col = taskDisp.argument + 2;
+    unsigned char _digits    = (taskDisp.command == DISP_CMD_BLIT_NUMBER);
+    unsigned char _width     = _digits ? DIGIT_X : FONT_X;
+
+    // Next column of the current glyph
+    taskDisp.counter++;
+    if (*glyph_col)
+    {
+        (*glyph_col)--;
+        datDisp.glyph++;
+        return 1;
+    }
+
+    // Next glyph of the current page
+    *glyph_col = _width - 1;
+    if (taskDisp.counter < (unsigned int)(*length * _width))
+    {
+        datDisp.string--;
+        disp_LoadBlitGlyph();
+        return 1;
+    }
+
+    // Next page of the string, start with the last glyph again
+    if (*row < _digits)
+    {
+        (*row)++;
+        taskDisp.counter = 0;
+        datDisp.string += *length - 1;
+        disp_LoadBlitGlyph();
+        return 1;
+    }
+
+    //Command finished, increase cursor
+    if (datDisp.x >= _width)
+        datDisp.x -= _width;
+    else
+    {
+        datDisp.x = DISP_SIZE_COL - 1;
+        if (datDisp.y < (DISP_SIZE_PAGE - 1 - _digits))
+            datDisp.y += 1 + _digits;
+        else
+            datDisp.y = 0;
+    }
+
+    // Exit the command
+    sarb_return(&taskDisp);
+    return 0;
+};
+
+/**
+ * @brief Get the glyph of a character in the character font.
+ * @param character The character to display.
+ * @return The pointer to the columns of the glyph, in the order they are sent.
+ * Characters which are not in the font are blank.
+ */
+const __flash unsigned char* disp_GetCharGlyph(unsigned char character)
+{
+    unsigned char _index = 0;
+    if ((character >= GLYPH_FONT_FIRST) && (character <= GLYPH_FONT_LAST))
+        _index = glyph_font_index[character - GLYPH_FONT_FIRST];
+    return glyph_font[_index];
+};
+
+/**
+ * @brief Set the x direction of the cursor for the next queued command.
  * @param x The x position as a multiple of the character size.
  */
 void disp_SetCursorX(unsigned char x)
 {
-    datDisp.x = DISP_SIZE_COL - FONT_X*(x + 1);
+    queueDisp.x = DISP_SIZE_COL - FONT_X*(x + 1);
 };
 
 /**
- * @brief Set the line of the cursor.
+ * @brief Set the line of the cursor for the next queued command.
  * @param line The line position as a multiple of the page size.
  */
 void disp_SetLine(unsigned char line)
 {
-    datDisp.y = line;
+    queueDisp.y = line;
 };
 
 /**
@@ -751,20 +1437,108 @@ void disp_SetLine(unsigned char line)
  * @param arg0 First argument for the command.
  * @param arg1 Second argument for the command.
  * @param arg2 Third argument for the command.
- * @return Returns 1 when the command was called successfully.
+ * @return Returns 1 when the command was queued successfully.
  */
 unsigned char disp_CallByValue(unsigned char cmd, unsigned char arg0,
     unsigned char arg1, unsigned char arg2)
 {
-    //Only call command when no other command is active
-    if (taskDisp.command == 0)
+    // Only call command when there is space in the queue
+    dispCall_t* _call = disp_QueuePush(cmd);
+    if (_call)
+    {
+        // Set the commands data
+        _call->argument[0] = arg0;
+        _call->argument[1] = arg1;
+        _call->argument[2] = arg2;
+        return 1;
+    }
+    return 0;
+};
+
+/**
+ * @brief Set the time stamp of the data for the next queued command.
+ * @param stamp The SysTick when the data was sampled.
+ * @details The latency is recorded when the command is finished.
+ * The stamp is only used for the next command.
+ */
+void disp_SetStamp(unsigned int stamp)
+{
+    queueDisp.stamp = stamp;
+    queueDisp.stamped = DISP_LATENCY;
+};
+
+#if DISP_LATENCY
+/**
+ * @brief Add one latency to the statistics.
+ * @param ticks The latency in SysTicks.
+ */
+void disp_RecordLatency(unsigned int ticks)
+{
+    // Stop before the count overflows
+    if (latencyDisp.count == 0xFFFF)
+        return;
+
+    if (!latencyDisp.count || (ticks < latencyDisp.min))
+        latencyDisp.min = ticks;
+    if (ticks > latencyDisp.max)
+        latencyDisp.max = ticks;
+    latencyDisp.sum += ticks;
+    latencyDisp.count++;
+};
+
+/**
+ * @brief Get the latency statistics of the time stamped commands.
+ * @return The pointer to the statistics.
+ */
+dispLatency_t* disp_GetLatency(void)
+{
+    return &latencyDisp;
+};
+
+/**
+ * @brief Get the average latency of the time stamped commands.
+ * @return The average latency in SysTicks.
+ */
+unsigned int disp_GetLatencyMean(void)
+{
+    if (!latencyDisp.count)
+        return 0;
+    return (unsigned int)(latencyDisp.sum / latencyDisp.count);
+};
+
+/**
+ * @brief Reset the latency statistics.
+ */
+void disp_ResetLatency(void)
+{
+    latencyDisp.min = 0;
+    latencyDisp.max = 0;
+    latencyDisp.sum = 0;
+    latencyDisp.count = 0;
+};
+#endif
+
+/**
+ * @brief Queue a rectangle which is filled with a constant byte.
+ * @param page_first The first page of the rectangle.
+ * @param page_last The last page of the rectangle.
+ * @param x_start The start column of the rectangle.
+ * @param x_end The end column of the rectangle, which is not filled anymore.
+ * @param pattern The byte which is written to every column.
+ * @return Returns 1 when the command was queued successfully.
+ */
+unsigned char disp_CallFillRect(unsigned char page_first, unsigned char page_last,
+    unsigned char x_start, unsigned char x_end, unsigned char pattern)
+{
+    // Only call command when there is space in the queue
+    dispCall_t* _call = disp_QueuePush(DISP_CMD_FILL_RECT);
+    if (_call)
     {
         // Set the commands data
-        taskDisp.argument[0] = arg0;
-        taskDisp.argument[1] = arg1;
-        taskDisp.argument[2] = arg2;
-        taskDisp.command     = cmd;
-        taskDisp.sequence    = 0;
+        _call->argument[0] = (page_first << 4) | page_last;
+        _call->argument[1] = x_start;
+        _call->argument[2] = x_end;
+        _call->pattern     = pattern;
         return 1;
     }
     return 0;
@@ -773,24 +1547,19 @@ unsigned char disp_CallByValue(unsigned char cmd, unsigned char arg0,
 /**
  * @brief Call a display command by passing a reference.
  *        Intended for writing strings.
+ *        The referenced data has to stay valid until the command is finished!
  * @param cmd The command to call.
  * @param pointer The reference to pass to the command.
- * @return  Returns 1 when the command was called successfully.
+ * @return  Returns 1 when the command was queued successfully.
  */
 unsigned char disp_CallByReference(unsigned char cmd, char* pointer)
 {
-    //Only call command when no other command is active
-    if (taskDisp.command == 0)
+    // Only call command when there is space in the queue
+    dispCall_t* _call = disp_QueuePush(cmd);
+    if (_call)
     {
-        // Set the commands data
-        taskDisp.argument[0] = 0;
-        taskDisp.argument[1] = 0;
-        taskDisp.argument[2] = 0;
-        taskDisp.command     = cmd;
-        taskDisp.sequence    = 0;
-
         // Pass the reference
-        datDisp.string = pointer;
+        _call->string = pointer;
         return 1;
     }
     return 0;
@@ -818,4 +1587,16 @@ void disp_BacklightOFF(void)
 void disp_BacklightToggle(void)
 {
     PORTDISP ^= (1<<DISP_BKL);
-};
\ No newline at end of file
+};
+
+//****** Interrupts ******
+#if DISP_SPI_ISR
+/**
+ * @brief SPI transfer complete, send the next byte of the transmit buffer.
+ * @details Interrupt-handler
+ */
+ISR(SPI_STC_vect)
+{
+    disp_TxNext();
+};
+#endif
\ No newline at end of file
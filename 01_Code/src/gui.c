@@ -31,14 +31,17 @@
 
 // ****** Variables ******
 task_t taskGUI; // Task struct for GUI
-char buffer1[16]; // Buffer1 for display string
-char buffer2[16]; // Buffer2 for display string
+char bufferWeight[8];   // Buffer for the weight string
+char bufferTime[8];     // Buffer for the time string
+char bufferBattery[8];  // Buffer for the battery string
 /*
- => double buffering is used, because the GUI does not know when the display is finished
- sending the data. Otherwise the GUI would override the content of the buffer while it
- is sent.
+ => every value has its own buffer, because the display commands are queued and
+ the strings are sent later. A new frame is only written when the display is
+ finished sending the previous one, otherwise the GUI would override the content
+ of the buffers while they are sent.
  */
-ScaleDat_t* datGUI;  // Pointer to the system data.
+ScaleDat_t datGUI;   // Snapshot of the scale data for one frame
+guiGraph_t graphGUI; // State of the weight graph
 
 // ****** Functions ******
 
@@ -55,6 +58,9 @@ ScaleDat_t* datGUI;  // Pointer to the system data.
  */
 void Task_GUI(void)
 {
+    // Plot the weight graph independently of the screen updates
+    gui_UpdateGraph();
+
     // Switch for active command
     switch (taskGUI.command)
     {
@@ -69,6 +75,10 @@ void Task_GUI(void)
     default:
         break;
     }
+
+    // Poll with the SysTick while the screen waits for the display
+    if (taskGUI.command)
+        post_tick(GUI_TASK);
 };
 
 /**
@@ -79,107 +89,86 @@ void gui_InitTask(void)
     sarb_InitStruct(&taskGUI);
     taskGUI.command = GUI_CMD_INIT;
 
-    // Get the pointer to the system data
-    datGUI = Scale_GetIPC();
+    // The graph starts when the static screen is written
+    graphGUI.active = 0;
+    graphGUI.column = GUI_GRAPH_COL_LAST;
+    graphGUI.pixel = 0;
+    graphGUI.stamp = 0;
 };
 
 /**
  * @brief Initialize the GUI interface.
+ * @details Only the regions which are not overwritten by the static
+ * content and the values are cleared, then the static content is queued
+ * in one pass, so it is written once the display has enough queue space left.
+ * The same sequence is used when the screen is switched back to the
+ * manual screen.
  */
 void gui_Init(void)
 {
-    // Perform the command sequences
     switch (taskGUI.sequence)
     {
-        case 0:
-            // Write the header line
-            if (gui_WriteString(0, 0, strcpy(buffer1, "oScale")))
-                taskGUI.sequence++;
-            break;
-
-        case 1:
-            // Write version to the header line
-            if (gui_WriteString(8, 0, strcpy(buffer2, VERSION)))
-                taskGUI.sequence++;
-            break;
-
-        case 2:
-            // Write the horizontal line
-            if (disp_CallByValue(DISP_CMD_LINE_H, 0, 128, 8))
-                taskGUI.sequence++;
-            break;
+    case 0:
+        // Stop the graph and clear its old trace
+        graphGUI.active = 0;
+        if (disp_CallFillRect(GUI_GRAPH_PAGE_FIRST, GUI_GRAPH_PAGE_LAST,
+            GUI_GRAPH_COL_FIRST - 1, GUI_GRAPH_COL_LAST + 1, 0x00))
+            taskGUI.sequence++;
+        break;
 
-        case 3:
-            taskGUI.counter = 0;
-            // Write the vertical line
-            if (disp_CallByValue(DISP_CMD_LINE_V, 1, 7, 64))
-                taskGUI.sequence++;
+    case 1:
+        // Wait until the whole screen fits into the display queue
+        if (disp_QueueFree() < GUI_INIT_CALLS)
             break;
 
-        case 4:
-            // Write the weight descriptor
-            if (gui_WriteString(0, 2, strcpy(buffer1, "Weight")))
-                taskGUI.sequence++;
-            break;
+        // Write the header line and the version
+        gui_WriteString(0, 0, "oScale");
+        gui_WriteString(8, 0, VERSION);
 
-        case 5:
-            // Write the Time descriptor
-            if (gui_WriteString(11, 2, strcpy(buffer2, "Time")))
-                taskGUI.sequence++;
-            break;
+        // Write the horizontal and the vertical line
+        disp_CallByValue(DISP_CMD_LINE_H, 0, 128, 8);
+        disp_CallByValue(DISP_CMD_LINE_V, 1, 7, 64);
 
-        case 6:
-            // Write the weight units
-            if (gui_WriteString(0, GUI_LINE_UNITS, strcpy(buffer1, "[g]")))
-                taskGUI.sequence++;
-            break;
+        // Write the weight and time descriptors
+        gui_WriteString(0, 2, "Weight");
+        gui_WriteString(11, 2, "Time");
 
-        case 7:
-            // Write the weight units
-            if (gui_WriteString(11, GUI_LINE_UNITS, strcpy(buffer2, "[min]  [s]")))
-                taskGUI.sequence++;
-            break;
+        // Write the units
+        gui_WriteString(0, GUI_LINE_UNITS, "[g]");
+        gui_WriteString(11, GUI_LINE_UNITS, "[min]  [s]");
 
-        case 8:
-            // Command ist finished
-            sarb_return(&taskGUI);
-            taskGUI.command = GUI_CMD_MANUAL;
-            break;
+        // Command ist finished, the graph starts again at its beginning
+        sarb_return(&taskGUI);
+        taskGUI.command = GUI_CMD_MANUAL;
+        graphGUI.column = GUI_GRAPH_COL_LAST;
+        graphGUI.stamp = get_ticks();
+        graphGUI.active = 1;
+        break;
 
-        default:
-            break;
+    default:
+        break;
     }
 };
 
 /**
  * @brief Perform the normal GUI operation.
+ * @details The whole frame is queued in one pass, when the previous
+ * frame is finished.
  */
 void gui_DisplayManual(void)
 {
-    // Perform the command sequence
-    switch (taskGUI.sequence)
-    {
-    case 0:
-        // Display the measured weight
-        if (gui_WriteWeight())
-            taskGUI.sequence++;
-        break;
-
-    case 1:
-        // Display the passed time
-        if(gui_WriteTime())
-            taskGUI.sequence++;
-        break;
-
-    case 2:
-        // Display the passed time
-        if(gui_WriteBattery())
-            sarb_return(&taskGUI);
-        break;
-
-    default:
-        break;
-    }
+    // Wait until the buffers of the previous frame are sent
+    if (disp_IsBusy())
+        return;
+
+    // All values of the frame belong to the same update of the scale data
+    scale_GetSnapshot(&datGUI);
+
+    // Display the measured weight, the passed time and the battery
+    gui_WriteWeight();
+    gui_WriteTime();
+    gui_WriteBattery();
+    sarb_return(&taskGUI);
 };
 
 /**
@@ -187,26 +176,21 @@ void gui_DisplayManual(void)
  * @param x The x-position for the string.
  * @param line The line number for the string.
  * @param buffer The pointer to the string buffer.
- * @return Returns 1 when the string write was successfully triggered.
+ * @return Returns 1 when the string write was successfully queued.
  */
 unsigned char gui_WriteString(unsigned char x, unsigned char line, char *buffer)
 {
-    // Only when display is not busy
-    if (!disp_IsBusy())
-    {
-        // set the cursor
-        disp_SetCursorX(x);
-        disp_SetLine(line);
+    // set the cursor
+    disp_SetCursorX(x);
+    disp_SetLine(line);
 
-        // Write the string until the end is reached
-        return disp_CallByReference(DISP_CMD_WRITE_STRING, buffer);
-    }
-    return 0;
+    // Write the string until the end is reached
+    return disp_CallByReference(DISP_CMD_BLIT_STRING, buffer);
 };
 
 /**
  * @brief Display the current measured weight in the display.
- * @return Returns 1 when the data write was successfully triggered.
+ * @return Returns 1 when the data write was successfully queued.
  */
 unsigned char gui_WriteWeight(void)
 {
@@ -214,105 +198,143 @@ unsigned char gui_WriteWeight(void)
     unsigned int _digit = 0;
 
     // Only when weight is positive
-    if (datGUI->Weight > 0)
-        _weight = (unsigned int)datGUI->Weight;
-
-    //When display is not busy
-    if (!disp_IsBusy())
-    {
-        // Get the single digits to display
-        // Digit 0
-        _digit = _weight / 1000;
-        _weight -= 1000 * _digit;
-        buffer1[0] = (unsigned char)(_digit + 48);
-        // Digit 1
-        _digit = _weight / 100;
-        _weight -= 100 * _digit;
-        buffer1[1] = (unsigned char)(_digit + 48);
-        // Digit 2
-        _digit = _weight / 10;
-        _weight -= 10 * _digit;
-        buffer1[2] = (unsigned char)(_digit + 48);
-        buffer1[3] = '.';
-        // Digit 3
-        buffer1[4] = (unsigned char)(_weight + 48);
-        buffer1[5] = 0;
-
-        // Set cursor
-        disp_SetCursorX(1);
-        disp_SetLine(GUI_LINE_VALUES);
-
-        // Write the content
-        return disp_CallByReference(DISP_CMD_WRITE_NUMBER, buffer1);
-    }
-    return 0;
+    if (datGUI.Weight > 0)
+        _weight = (unsigned int)datGUI.Weight;
+
+    // Get the single digits to display
+    // Digit 0
+    _digit = _weight / 1000;
+    _weight -= 1000 * _digit;
+    bufferWeight[0] = (unsigned char)(_digit + 48);
+    // Digit 1
+    _digit = _weight / 100;
+    _weight -= 100 * _digit;
+    bufferWeight[1] = (unsigned char)(_digit + 48);
+    // Digit 2
+    _digit = _weight / 10;
+    _weight -= 10 * _digit;
+    bufferWeight[2] = (unsigned char)(_digit + 48);
+    bufferWeight[3] = '.';
+    // Digit 3
+    bufferWeight[4] = (unsigned char)(_weight + 48);
+    bufferWeight[5] = 0;
+
+    // Set cursor and the time stamp of the sample
+    disp_SetCursorX(1);
+    disp_SetLine(GUI_LINE_VALUES);
+    disp_SetStamp(datGUI.Stamp);
+
+    // Write the content
+    return disp_CallByReference(DISP_CMD_BLIT_NUMBER, bufferWeight);
 };
 
 /**
  * @brief Display the passed time in the display.
- * @return Returns 1 when the data write was successfully triggered.
+ * @return Returns 1 when the data write was successfully queued.
  */
 unsigned char gui_WriteTime(void)
 {
-    unsigned int _time = datGUI->Time;
+    unsigned int _time = datGUI.Time;
     unsigned int _digit = 0;
-    //When display is not busy
-    if (!disp_IsBusy())
-    {
-        // Get the single digits to display
-        // Digit 0
-        _digit = _time / 600;
-        _time -= 600 * _digit;
-        buffer2[0] = (unsigned char)(_digit + 48);
-        // Digit 1
-        _digit = _time / 60;
-        _time -= 60 * _digit;
-        buffer2[1] = (unsigned char)(_digit + 48);
-        buffer2[2] = ':';
-        // Digit 2
-        _digit = _time / 10;
-        _time -= 10 * _digit;
-        buffer2[3] = (unsigned char)(_digit + 48);
-        
-        // Digit 3
-        buffer2[4] = (unsigned char)(_time + 48);
-        buffer2[5] = 0;
-
-        // Set cursor
-        disp_SetCursorX(12);
-        disp_SetLine(GUI_LINE_VALUES);
-
-        // Write the content
-        return disp_CallByReference(DISP_CMD_WRITE_NUMBER, buffer2);
-    }
-    return 0;
+    // Get the single digits to display
+    // Digit 0
+    _digit = _time / 600;
+    _time -= 600 * _digit;
+    bufferTime[0] = (unsigned char)(_digit + 48);
+    // Digit 1
+    _digit = _time / 60;
+    _time -= 60 * _digit;
+    bufferTime[1] = (unsigned char)(_digit + 48);
+    bufferTime[2] = ':';
+    // Digit 2
+    _digit = _time / 10;
+    _time -= 10 * _digit;
+    bufferTime[3] = (unsigned char)(_digit + 48);
+    
+    // Digit 3
+    bufferTime[4] = (unsigned char)(_time + 48);
+    bufferTime[5] = 0;
+
+    // Set cursor
+    disp_SetCursorX(12);
+    disp_SetLine(GUI_LINE_VALUES);
+
+    // Write the content
+    return disp_CallByReference(DISP_CMD_BLIT_NUMBER, bufferTime);
 };
 
 /**
  * @brief Display the charge of the battery.
- * @return Returns 1 when the data write was successfully triggered.
+ * @return Returns 1 when the data write was successfully queued.
  */
 unsigned char gui_WriteBattery(void)
 {
-    //When display is not busy
-    if (!disp_IsBusy())
-    {
-        // Set cursor
-        disp_SetCursorX(16);
-        disp_SetLine(0);
-
-        // Get the SoC
-        GUI_Num2Str(buffer1, datGUI->SoC, 2);
-        buffer1[2] = '%';
-        buffer1[3] = ' ';
-        buffer1[4] = 7 + (datGUI->SoC/25);
-        buffer1[5] = 0;
-
+    // Set cursor
+    disp_SetCursorX(16);
+    disp_SetLine(0);
+
+    // Get the SoC
+    GUI_Num2Str(bufferBattery, datGUI.SoC, 2);
+    bufferBattery[2] = '%';
+    bufferBattery[3] = ' ';
+    bufferBattery[4] = 7 + (datGUI.SoC/25);
+    bufferBattery[5] = 0;
+
+    // Write the content
+    return disp_CallByReference(DISP_CMD_BLIT_STRING, bufferBattery);
+};
 
-        // Write the content
-        return disp_CallByReference(DISP_CMD_WRITE_STRING, buffer1);
+/**
+ * @brief Plot the weight graph with a fixed sample rate.
+ * @details Every sample only writes its own column and clears the
+ * column in front of it, the graph is never redrawn. Consecutive
+ * samples are connected with a vertical line.
+ * The samples are timed with the SysTicks, so the additional runs of
+ * the GUI task for the screen do not change the sample rate.
+ */
+void gui_UpdateGraph(void)
+{
+    // Only when the static screen content is written
+    if (!graphGUI.active)
+        return;
+
+    // Wait for the next sample
+    unsigned int _ticks = get_ticks();
+    if ((unsigned int)(_ticks - graphGUI.stamp) & 0x8000)
+        return;
+
+    // Scale the weight to the height of the graph
+    signed int _weight = scale_GetWeight();
+    unsigned char _pixel = 0;
+    if (_weight >= GUI_GRAPH_FULL_SCALE)
+        _pixel = GUI_GRAPH_HEIGHT - 1;
+    else if (_weight > 0)
+        _pixel = (unsigned char)(((unsigned int)_weight * GUI_GRAPH_HEIGHT) / GUI_GRAPH_FULL_SCALE);
+
+    // Connect the sample with the previous one
+    unsigned char _range = (graphGUI.pixel << 4) | _pixel;
+    if (_pixel > graphGUI.pixel)
+        _range = (_pixel << 4) | graphGUI.pixel;
+
+    // Retry with the next SysTick when the queue is full
+    if (!disp_CallByValue(DISP_CMD_PLOT_COLUMN, graphGUI.column,
+        (GUI_GRAPH_PAGE_FIRST << 4) | GUI_GRAPH_PAGE_LAST, _range))
+    {
+        post_tick(GUI_TASK);
+        return;
     }
-    return 0;
+
+    // Keep the sample rate, start again when more than one sample was missed
+    graphGUI.stamp += GUI_GRAPH_TICKS;
+    if (!((unsigned int)(_ticks - graphGUI.stamp) & 0x8000))
+        graphGUI.stamp = _ticks + GUI_GRAPH_TICKS;
+
+    // Advance to the next column, the graph moves to the right on the screen
+    graphGUI.pixel = _pixel;
+    if (graphGUI.column > GUI_GRAPH_COL_FIRST)
+        graphGUI.column--;
+    else
+        graphGUI.column = GUI_GRAPH_COL_LAST;
 };
 
 /**
@@ -331,6 +353,7 @@ unsigned char GUI_Draw(unsigned char screen)
         taskGUI.argument[2] = 0;
         taskGUI.command     = screen;
         taskGUI.sequence    = 0;
+        post_event(GUI_TASK);
         return 1;
     }
     return 0;
@@ -28,10 +28,30 @@
  */
 // ****** Includes ******
 #include "oScale.h"
+#include <avr/sleep.h>
 
 // ****** Variables ******
 volatile unsigned char TickPassed = 0;
 
+// ****** Task Table ******
+// The periods have to be a multiple of the SysTick and fit into the 16-bit schedule
+#define SYS_CHECK_TASK(task, period_us, function)                                           \
+  _Static_assert((task) < NUM_TASKS, #function ": The task group does not exist!");         \
+  _Static_assert(((period_us) % SYSTICK_us) == 0, #function ": The period is not a multiple of SYSTICK_us!"); \
+  _Static_assert(((period_us) == 0) || (SYS_TICKS(period_us) <= 0xFFFFUL),                 \
+    #function ": The period does not fit into the schedule!");
+SYS_TASK_TABLE(SYS_CHECK_TASK)
+
+// The reload values are constants, no division at runtime
+#define SYS_SCHEDULE_TASK(task, period_us, function)  \
+  if ((period_us) == 0)                               \
+    schedule_event(task);                             \
+  else                                                \
+    schedule(task, SYS_TICKS(period_us));
+
+// Call the functions of the waiting task group
+#define SYS_DISPATCH_TASK(task, period_us, function) if (_task == (task)) function();
+
 // ****** Main ******
 int main(void)
 {
@@ -40,15 +60,20 @@ int main(void)
   scale_InitSysTick();
 
   // Initialize tasks
-  disp_InitTask(TASK0_us);
+  disp_InitTask(SYSTICK_us);
   gui_InitTask();
   adc_InitTask();
 
   // Schedule tasks
   scheduler_init(SYSTICK_us);
-  schedule_us(TASK0, TASK0_us);
-  schedule_ms(TASK1, TASK1_ms);
-  schedule_ms(TASK2, TASK2_ms);
+  SYS_TASK_TABLE(SYS_SCHEDULE_TASK)
+
+  // Start the init sequences of the display and the GUI
+  post_event(DISP_TASK);
+  post_event(GUI_TASK);
+
+  // The CPU sleeps between the SysTicks, the timer keeps running
+  set_sleep_mode(SLEEP_MODE_IDLE);
 
   // Start SysTick Timer
   sei();
@@ -59,27 +84,37 @@ int main(void)
     if (TickPassed)
     {
       TickPassed = 0;
-      // ****** TASK0 (5 kHz) ******
-      if (run(TASK0))
-      {
-        Task_Disp();
-        Task_GUI();
-      }
 
-      // ****** TASK1 (100 Hz) ******
-      if (run(TASK1))
+      // Run all waiting tasks, the lowest task number first
+      unsigned char _task;
+      while ((_task = next_task()) != NO_TASK)
       {
-        Task_ADC();
+        begin_task(_task, &TCNT0);
+        SYS_TASK_TABLE(SYS_DISPATCH_TASK)
+        end_task(_task, &TCNT0);
       }
 
-      // ****** TASK2 (5 Hz) ******
-      if (run(TASK2))
-      {
-        Task_SYS();
-      }
+      // Count the active time of this tick, 1 timer count = 8 CPU cycles
+      count_busy(TickPassed ? OCR0A + 1 : TCNT0);
     }
 
     // ****** free-running ******
+
+#if SYS_SLEEP_IDLE
+    // ****** idle ******
+    // Check the flag with disabled interrupts, so the SysTick cannot occur between
+    // the check and the sleep. The instruction after sei() is always executed
+    // before a pending interrupt, so the CPU wakes up with the next interrupt.
+    cli();
+    if (!TickPassed)
+    {
+      sleep_enable();
+      sei();
+      sleep_cpu();
+      sleep_disable();
+    }
+    sei();
+#endif
   }
   return 0;
 };
@@ -93,4 +128,5 @@ ISR(TIMER0_COMPA_vect)
 {
   TickPassed = 1;
   run_scheduler();
+  adc_TickISR();
 };
\ No newline at end of file
@@ -32,6 +32,7 @@
 // ****** Variables ******
 task_t taskScale;  // The task struct of the scale task.
 ScaleDat_t datScale; // The scale data
+volatile unsigned char seqScale; // Sequence of the scale data, odd while it is written
 SysDat_t oScale;    // The system data of the scale
 
 unsigned char temp_timer_enable = 0;
@@ -97,8 +98,9 @@ void scale_StateManual(void)
      * but is only precise to +-1g.
      */
     // datScale.Weight = scale_ConvertSample( adc_GetValue() );
-    datScale.Weight = 0x1000 - adc_GetValue();
-    datScale.Weight -= oScale.WeightOffset;
+    scale_BeginWrite();
+    datScale.Weight = scale_GetWeight();
+    datScale.Stamp = adc_GetStamp();
 
     // check whether keys are pressed
     unsigned char _KeyPressed = scale_GetKeyPressed();
@@ -124,6 +126,11 @@ void scale_StateManual(void)
     if (_KeyPressed & (1<<KEY3))
         temp_timer_enable ^= 1;
 
+#if SYS_LOW_RATE
+    // Slow down when nothing happens
+    scale_UpdateRate(_KeyPressed | (oScale.KeyState[1] ^ oScale.KeyState[0]));
+#endif
+
     // Temporary timing
     if (temp_timer_enable)
     {
@@ -135,6 +142,7 @@ void scale_StateManual(void)
             datScale.Time++;
         }    
     }
+    scale_EndWrite();
 };
 
 /**
@@ -175,9 +183,14 @@ void scale_InitTask(void)
     oScale.Calibration[0]   = 994; // [0.1*mg/LSB]
     oScale.Calibration[1]   = -6561; // [mg]
     oScale.WeightOffset     = 0;
+    oScale.WeightIdle       = 0;
+    oScale.CounterIdle      = SYS_IDLE_RUNS;
+    oScale.RateLow          = 0;
     datScale.Weight         = 0; // 0.1 [g]
     datScale.Time           = 0; // [s]
     datScale.SoC            = 0; // [%]
+    datScale.Stamp          = 0; // [SysTicks]
+    seqScale                = 0;
 
     /* Initialize ADC:
      * - ADC0 is Input
@@ -189,16 +202,61 @@ void scale_InitTask(void)
     ADMUX = (1<<ADLAR);
     DIDR0 = (1<<ADC0D);
     ADCSRA = (1<<ADEN) | (1<<ADPS2);
+
+    // The keys wake up the system task in the low rate profile
+    PCMSK2 = KEY_PCINT;
 };
 
 /**
- * @brief Get the pointer to the scale data.
- * @return The pointer to the data.
- * @details This is used as a poor-mans IPC to save RAM and flash.
+ * @brief Start to change the scale data.
+ * @details The sequence is odd until scale_EndWrite() is called, so the
+ * readers know that the data is not consistent. Only one writer is allowed.
  */
-ScaleDat_t* Scale_GetIPC(void)
+void scale_BeginWrite(void)
 {
-    return &datScale;
+    seqScale++;
+    SYS_BARRIER();
+};
+
+/**
+ * @brief Finish the change of the scale data.
+ */
+void scale_EndWrite(void)
+{
+    SYS_BARRIER();
+    seqScale++;
+};
+
+/**
+ * @brief Try to copy a consistent snapshot of the scale data.
+ * @param snapshot The pointer to the copy.
+ * @return Returns 1 when the copy is consistent, 0 when the data was
+ * written before or during the copy.
+ * @details A reader which can interrupt the writer, e.g. an interrupt,
+ * has to use this, because the writer cannot finish while it waits.
+ */
+unsigned char scale_TryGetSnapshot(ScaleDat_t* snapshot)
+{
+    unsigned char _sequence = seqScale;
+    if (_sequence & 1)
+        return 0;
+
+    SYS_BARRIER();
+    memcpy(snapshot, &datScale, sizeof(ScaleDat_t));
+    SYS_BARRIER();
+    return (_sequence == seqScale);
+};
+
+/**
+ * @brief Copy a consistent snapshot of the scale data.
+ * @param snapshot The pointer to the copy.
+ * @details The copy is repeated until no write occurred in between,
+ * so the interrupts do not have to be disabled for the whole copy.
+ * Must not be called where it interrupts the writer.
+ */
+void scale_GetSnapshot(ScaleDat_t* snapshot)
+{
+    while (!scale_TryGetSnapshot(snapshot));
 };
 
 /**
@@ -297,6 +355,17 @@ void scale_UpdateGUI(void)
     }
 };
 
+/**
+ * @brief Get the current weight from the filtered ADC value.
+ * @details Can be called at any time, so the GUI can sample the
+ * weight faster than the system task updates it.
+ * @return The zeroed weight in [0.1 g].
+ */
+signed int scale_GetWeight(void)
+{
+    return (signed int)(0x1000 - adc_GetValue()) - oScale.WeightOffset;
+};
+
 /**
  * @brief Converts the ADC Sample to weight in [g], applies the calibration.
  */
@@ -329,8 +398,61 @@ void scale_GetSoC(void)
          * The SoC is 100% when ADCH==200 and 0% when ADCH==140
          * => SoC = (ADCH - 140)/0.6 = ... = (10 * ((ADCH-140)/3) )/2
          */
+        scale_BeginWrite();
         datScale.SoC = (10 * ((ADCH - 140)/3))/2;
+        scale_EndWrite();
     }
     else // Start a new ADC conversion
         ADCSRA |= (1<<ADSC);   
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Switch between the full and the low rate profile of the system task.
+ * @details The low rate profile is used when the weight did not change more
+ * than SYS_IDLE_DELTA for SYS_IDLE_s and the timer is stopped. The full rate
+ * is used again with the next change of the weight or the keys. In the low
+ * rate profile a key edge starts the system task right away with the pin
+ * change interrupt, so short key presses are not missed.
+ * The new schedule keeps the phase of the task, when the scheduler did not
+ * apply the previous change yet, the switch is repeated in the next run.
+ * @param keys The keys which changed since the last run.
+ */
+void scale_UpdateRate(unsigned char keys)
+{
+    signed int _delta = datScale.Weight - oScale.WeightIdle;
+
+    if (keys || temp_timer_enable || (_delta > SYS_IDLE_DELTA) || (_delta < -SYS_IDLE_DELTA))
+    {
+        // Something happened, start counting again
+        oScale.WeightIdle = datScale.Weight;
+        oScale.CounterIdle = SYS_IDLE_RUNS;
+        if (oScale.RateLow && reschedule(TASK2, SYS_TICKS(TASK2_ms * 1000UL)))
+        {
+            PCICR &= ~(1<<PCIE2);
+            oScale.RateLow = 0;
+        }
+    }
+    else if (oScale.CounterIdle)
+        oScale.CounterIdle--;
+    else if (!oScale.RateLow && reschedule(TASK2, SYS_TICKS(TASK2_LOW_ms * 1000UL)))
+    {
+        PCIFR = (1<<PCIF2); // Forget the old edges
+        oScale.RateLow = 1;
+    }
+
+    // Arm the key interrupt again, the last edge could have been a bounce
+    if (oScale.RateLow)
+        PCICR |= (1<<PCIE2);
+};
+
+//****** Interrupts ******
+/**
+ * @brief Pin change interrupt of the keys.
+ * @details Only enabled in the low rate profile, the system task
+ * reads the keys and switches back to the full rate.
+ */
+ISR(PCINT2_vect)
+{
+    PCICR &= ~(1<<PCIE2);
+    post_event_isr(TASK2);
+};
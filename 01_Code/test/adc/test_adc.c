@@ -0,0 +1,279 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_adc.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Unit test for the sampling of the external ADC.
+ *          The SysTick and the compare match interrupt are triggered by the test.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <scheduler.h>
+#include <filter8.h>
+
+// The data line follows the bit sequence of the test
+void test_ClockEdge(void);
+#define ADC_CLOCK_EDGE() test_ClockEdge()
+#include "../../src/adc.c"
+
+// ****** Variables ******
+extern volatile schedule_t os; // The scheduler data
+unsigned char JitterADC;        // Delay of the compare match interrupt in timer counts
+const char* SequenceADC;        // Bits of the data line as '0' and '1', 0 keeps the data line
+unsigned char EdgesADC;         // Rising clock edges of the sample
+
+// ****** Functions ******
+/**
+ * @brief Set the data line for the next bit, called with every rising clock edge.
+ */
+void test_ClockEdge(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(0, PORTADC & (1<<ADC_CS));
+    TEST_ASSERT_EQUAL_UINT8(1<<ADC_CLK, PORTADC & (1<<ADC_CLK));
+    if (SequenceADC)
+    {
+        if (SequenceADC[EdgesADC] == '1')
+            PINADC |= (1<<ADC_DATA);
+        else
+            PINADC &= ~(1<<ADC_DATA);
+    }
+    EdgesADC++;
+};
+
+/**
+ * @brief Read one sample with a bit sequence on the data line.
+ * @param sequence The 15 bits of the data line.
+ * @return The read sample.
+ */
+unsigned int test_Sample(const char* sequence)
+{
+    SequenceADC = sequence;
+    EdgesADC = 0;
+    unsigned int _value = adc_Sample();
+    SequenceADC = 0;
+
+    // Every bit is clocked and the ADC is released
+    TEST_ASSERT_EQUAL_UINT8(ADC_SAMPLE_BITS, EdgesADC);
+    TEST_ASSERT_EQUAL_UINT8(1<<ADC_CS, PORTADC & ((1<<ADC_CS) | (1<<ADC_CLK)));
+    return _value;
+};
+
+/**
+ * @brief Simulate one SysTick with the compare match B in it.
+ * @return Returns the task which was started by the tick, NO_TASK when none.
+ */
+unsigned char test_Tick(void)
+{
+    // SysTick interrupt
+    run_scheduler();
+    adc_TickISR();
+
+    // Compare match B, delayed by another interrupt
+    if (TIMSK0 & (1<<OCIE0B))
+    {
+        TCNT0 = ADC_SAMPLE_TCNT + JitterADC;
+        TIMER0_COMPB_vect();
+    }
+
+    // Main loop
+    unsigned char _task = next_task();
+    if (_task == ADC_TASK)
+        Task_ADC();
+    return _task;
+};
+
+/**
+ * @brief Initialize the scheduler and the ADC like main.c.
+ */
+void test_Init(void)
+{
+    scheduler_init(SYSTICK_us);
+    schedule_event(ADC_TASK);
+    TIMSK0 = (1<<OCIE0A);
+    JitterADC = 0;
+    adc_InitTask();
+};
+
+/**
+ * @brief Test that the samples are read in the interrupt with the sample rate.
+ * @details unit test
+ */
+void test_sample_rate(void)
+{
+    test_Init();
+    TEST_ASSERT_EQUAL_UINT8(ADC_SAMPLE_TCNT, OCR0B);
+
+    // The data line is high, every bit is 1
+    PIND = (1<<ADC_DATA);
+
+    // The first sample is read with the first SysTick, the first
+    // block is complete with the ADC_BLOCK-th sample
+    unsigned int _first = 1 + (ADC_BLOCK - 1) * ADC_OSR_TICKS;
+    for (unsigned int tick = 1; tick < _first; tick++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(NO_TASK, test_Tick());
+        TEST_ASSERT_EQUAL_UINT8(1<<OCIE0A, TIMSK0);
+    }
+    TEST_ASSERT_EQUAL_UINT8(ADC_TASK, test_Tick());
+    TEST_ASSERT_EQUAL_UINT16(_first, adc_GetStamp());
+    TEST_ASSERT_EQUAL_UINT16(_first, adcBlock[0].stamp);
+    TEST_ASSERT_EQUAL_UINT16(0x0FFF, adcBlock[0].sample[ADC_BLOCK - 1]);
+    TEST_ASSERT_EQUAL_UINT16((0x0FFFUL * ADC_OSR) >> adcDecimator.Shift, GetDecimator(&adcDecimator));
+    TEST_ASSERT_EQUAL_UINT8(0, adcBlockReady);
+    TEST_ASSERT_EQUAL_UINT8(0, TIMSK0 & (1<<OCIE0B));
+    TEST_ASSERT_EQUAL_UINT8(1<<OCIE0A, TIMSK0);
+
+    // The filter task is only started by the full blocks
+    for (unsigned int tick = 1; tick < ADC_BLOCK * ADC_OSR_TICKS; tick++)
+        TEST_ASSERT_EQUAL_UINT8(NO_TASK, test_Tick());
+    TEST_ASSERT_EQUAL_UINT8(ADC_TASK, test_Tick());
+    TEST_ASSERT_EQUAL_UINT16(_first + ADC_BLOCK * ADC_OSR_TICKS, adc_GetStamp());
+    TEST_ASSERT_EQUAL_UINT8(0, adcBlockWrite);
+};
+
+/**
+ * @brief Test the hand over of the blocks between the interrupt and the task.
+ * @details unit test
+ */
+void test_sample_block(void)
+{
+    test_Init();
+
+    // Fill the first block with a ramp, the interrupt continues with the second block
+    for (unsigned int sample = 0; sample < ADC_BLOCK; sample++)
+    {
+        PIND = (sample & 1) ? (1<<ADC_DATA) : 0;
+        TIMER0_COMPB_vect();
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, adcBlockReady);
+    TEST_ASSERT_EQUAL_UINT8(1, adcBlockWrite);
+    TEST_ASSERT_EQUAL_UINT8(ADC_TASK, next_task());
+
+    // The task is late, the next full block is dropped and the ready one is kept
+    PIND = (1<<ADC_DATA);
+    for (unsigned int sample = 0; sample < ADC_BLOCK; sample++)
+        TIMER0_COMPB_vect();
+    TEST_ASSERT_EQUAL_UINT8(1, adc_GetTiming()->overrun);
+    TEST_ASSERT_EQUAL_UINT8(1, adcBlockWrite);
+    for (unsigned int sample = 0; sample < ADC_BLOCK; sample++)
+        TEST_ASSERT_EQUAL_UINT16((sample & 1) ? 0x0FFF : 0, adcBlock[0].sample[sample]);
+
+    // The task filters the whole block in one pass and releases it
+    Task_ADC();
+    TEST_ASSERT_EQUAL_UINT8(0, adcBlockReady);
+    TEST_ASSERT_EQUAL_UINT16(((0x0FFFUL * ADC_OSR) >> adcDecimator.Shift) / 2, GetDecimator(&adcDecimator));
+
+    // Another run without a block does not change the filter
+    unsigned int _value = adc_GetValueFine();
+    Task_ADC();
+    TEST_ASSERT_EQUAL_UINT16(_value, adc_GetValueFine());
+};
+
+/**
+ * @brief Test the measurement of the sample jitter and the overruns.
+ * @details unit test
+ */
+void test_sample_timing(void)
+{
+    test_Init();
+
+    // Without other interrupts the samples start at the same count
+    for (unsigned int tick = 0; tick < 4 * ADC_SAMPLE_TICKS; tick++)
+        test_Tick();
+    TEST_ASSERT_EQUAL_UINT8(0, adc_GetJitter());
+    TEST_ASSERT_EQUAL_UINT8(ADC_SAMPLE_TCNT, adc_GetTiming()->min);
+
+    // A delayed interrupt is measured
+    JitterADC = 3;
+    for (unsigned int tick = 0; tick < ADC_SAMPLE_TICKS; tick++)
+        test_Tick();
+    TEST_ASSERT_EQUAL_UINT8(3, adc_GetJitter());
+    TEST_ASSERT_EQUAL_UINT8(0, adc_GetTiming()->overrun);
+
+    // A block which is not filtered before the next one is full is an overrun
+    adc_ResetTiming();
+    TEST_ASSERT_EQUAL_UINT8(0, adc_GetJitter());
+    for (unsigned int sample = 0; sample < 2 * ADC_BLOCK; sample++)
+        TIMER0_COMPB_vect();
+    TEST_ASSERT_EQUAL_UINT8(1, adc_GetTiming()->overrun);
+};
+
+/**
+ * @brief Test the resolution of the decimated and filtered value.
+ * @details unit test
+ */
+void test_oversampling(void)
+{
+    test_Init();
+
+    // The input toggles between two codes, the mean is between them
+    const char* _codes[2] = {"000" "011111111111", "000" "100000000000"};
+    for (unsigned int sample = 0; sample < 200U * ADC_OSR; sample++)
+    {
+        SequenceADC = _codes[sample & 1];
+        EdgesADC = 0;
+        TIMER0_COMPB_vect();
+        if (adcBlockReady)
+            Task_ADC();
+    }
+    SequenceADC = 0;
+
+    // The decimated sample resolves the half code
+    TEST_ASSERT_EQUAL_UINT16(((0x0FFFUL * ADC_OSR) >> adcDecimator.Shift) / 2, GetDecimator(&adcDecimator));
+
+    // The PT1 settles 0.3 % below 0x07FF.5 because of the truncation
+    unsigned int _mean = (0x07FF << ADC_OSR_BITS) + (1 << ADC_OSR_BITS) / 2;
+    TEST_ASSERT_UINT16_WITHIN(_mean / 250, _mean, adc_GetValueFine());
+    TEST_ASSERT_EQUAL_UINT16(adc_GetValueFine() >> ADC_OSR_BITS, adc_GetValue());
+};
+
+/**
+ * @brief Test the bit order of a sample.
+ * @details unit test
+ */
+void test_sample_bits(void)
+{
+    test_Init();
+
+    // The 3 leading bits are not part of the value
+    TEST_ASSERT_EQUAL_UINT16(0x0000, test_Sample("111" "000000000000"));
+    TEST_ASSERT_EQUAL_UINT16(0x0FFF, test_Sample("000" "111111111111"));
+
+    // The MSB comes first
+    TEST_ASSERT_EQUAL_UINT16(0x0800, test_Sample("000" "100000000000"));
+    TEST_ASSERT_EQUAL_UINT16(0x0001, test_Sample("010" "000000000001"));
+    TEST_ASSERT_EQUAL_UINT16(0x0A5C, test_Sample("101" "101001011100"));
+    TEST_ASSERT_EQUAL_UINT16(0x0123, test_Sample("000" "000100100011"));
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_rate);
+    RUN_TEST(test_sample_block);
+    RUN_TEST(test_sample_timing);
+    RUN_TEST(test_sample_bits);
+    RUN_TEST(test_oversampling);
+    return UNITY_END();
+};
@@ -0,0 +1,315 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_bench_scheduler.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Jitter and latency benchmark of the scheduler.
+ *          The SysTick is simulated in us, the tasks only consume the
+ *          injected execution times. The main loop runs all waiting tasks
+ *          after every SysTick, like main.c, and the SysTick interrupts the
+ *          running task when its time is reached.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <stdio.h>
+#include <scheduler.h>
+#include "oScale.h"
+
+// ****** Defines ******
+#define BENCH_TASKS         4       // Number of simulated task groups
+#define BENCH_TIME_us       10000000UL // Simulated time of one benchmark: 10 s
+#define BENCH_BIN_us        50      // Width of one histogram bin
+#define BENCH_BINS          12      // Number of histogram bins, the last one counts all longer latencies
+#define BENCH_BAR           40      // Length of the longest histogram bar
+
+// ****** Variables ******
+extern volatile schedule_t os; // The scheduler data
+
+typedef struct  // Injected execution time of one task
+{
+    unsigned int min;       // Shortest execution time in us
+    unsigned int max;       // Longest execution time in us
+    unsigned int peak;      // Execution time of the rare long runs in us, 0 disables them
+    unsigned int peak_rate; // Every n-th run takes the peak time
+} benchLoad_t;
+
+typedef struct  // Results of one task
+{
+    unsigned long period;       // Period of the task in us
+    unsigned long release;      // Time when the task was signaled
+    unsigned long runs;         // Number of started runs
+    unsigned long missed;       // Releases which were skipped, the task was still waiting
+    unsigned long late;         // Runs which finished after the next release
+    unsigned long sum;          // Sum of the start latencies for the mean
+    unsigned long min;          // Shortest start latency in us
+    unsigned long max;          // Longest start latency in us
+    unsigned long bins[BENCH_BINS]; // Histogram of the start latencies
+} benchTask_t;
+
+benchLoad_t loadBench[BENCH_TASKS];
+benchTask_t resultBench[BENCH_TASKS];
+unsigned long randBench;    // State of the pseudo random execution times
+
+// ****** Functions ******
+
+/**
+ * @brief Get the next injected execution time of a task.
+ * @param task The number of the task(group).
+ * @return The execution time in us.
+ */
+unsigned long bench_ExecTime(unsigned char task)
+{
+    benchLoad_t* _load = &loadBench[task];
+
+    // The rare long runs, like a screen switch or a long command
+    if (_load->peak && _load->peak_rate && !(resultBench[task].runs % _load->peak_rate))
+        return _load->peak;
+
+    // Deterministic pseudo random time between min and max
+    randBench = randBench * 1103515245UL + 12345UL;
+    unsigned int _range = _load->max - _load->min + 1;
+    return _load->min + ((randBench >> 16) % _range);
+};
+
+/**
+ * @brief Simulate the SysTick interrupt and record the releases.
+ * @param time The time of the SysTick in us.
+ */
+void bench_SysTick(unsigned long time)
+{
+    unsigned char _waiting = os.ready ^ os.taken;
+    unsigned char _ready = os.ready;
+    unsigned int _tick = os.ticks + 1;
+    run_scheduler();
+    unsigned char _released = os.ready ^ _ready;
+
+    for (unsigned char task = 0; task < BENCH_TASKS; task++)
+    {
+        benchTask_t* _result = &resultBench[task];
+        unsigned int _period = (unsigned int)(_result->period / SYSTICK_us);
+        if (!_period || (_tick % _period))
+            continue;
+
+        // The task expires in this tick, it is skipped when it still waits
+        if (_released & (1<<task))
+            _result->release = time;
+        else if (_waiting & (1<<task))
+            _result->missed++;
+    }
+};
+
+/**
+ * @brief Run the benchmark with the loads set in loadBench.
+ * @param periods_us The period of every task in us.
+ * @param duration The simulated time in us.
+ */
+void bench_Run(const unsigned long* periods_us, unsigned long duration)
+{
+    // Initialize the scheduler and the results
+    scheduler_init(SYSTICK_us);
+    for (unsigned char task = 0; task < BENCH_TASKS; task++)
+    {
+        resultBench[task] = (benchTask_t){0};
+        resultBench[task].period = periods_us[task];
+        resultBench[task].min = 0xFFFFFFFFUL;
+        if (periods_us[task])
+            schedule(task, (unsigned int)(periods_us[task] / SYSTICK_us));
+    }
+    randBench = 1;
+
+    // The main loop, the time only advances in the tasks and the idle mode
+    unsigned long _time = 0;
+    unsigned long _tick = SYSTICK_us;
+    while (_time < duration)
+    {
+        unsigned char _task = next_task();
+        if (_task == NO_TASK)
+        {
+            // Sleep until the next SysTick
+            _time = _tick;
+            bench_SysTick(_tick);
+            _tick += SYSTICK_us;
+            continue;
+        }
+
+        // Record the start latency
+        benchTask_t* _result = &resultBench[_task];
+        unsigned long _deadline = _result->release + _result->period;
+        unsigned long _latency = _time - _result->release;
+        unsigned char _bin = (unsigned char)(_latency / BENCH_BIN_us);
+        if (_bin >= BENCH_BINS)
+            _bin = BENCH_BINS - 1;
+        _result->bins[_bin]++;
+        _result->sum += _latency;
+        if (_latency < _result->min)
+            _result->min = _latency;
+        if (_latency > _result->max)
+            _result->max = _latency;
+
+        // Run the task, the SysTicks interrupt it
+        unsigned long _end = _time + bench_ExecTime(_task);
+        while (_tick <= _end)
+        {
+            bench_SysTick(_tick);
+            _tick += SYSTICK_us;
+        }
+        _time = _end;
+        if (_end > _deadline)
+            _result->late++;
+        _result->runs++;
+    }
+};
+
+/**
+ * @brief Print the results and the histograms of all tasks.
+ * @param name The name of the benchmark.
+ */
+void bench_Report(const char* name)
+{
+    char message[128];
+    sprintf(message, "%s: start latency in us, bins of %u us", name, BENCH_BIN_us);
+    TEST_MESSAGE(message);
+
+    for (unsigned char task = 0; task < BENCH_TASKS; task++)
+    {
+        benchTask_t* _result = &resultBench[task];
+        sprintf(message, "TASK%u (%lu us): %lu runs, latency min %lu max %lu mean %lu, jitter %lu, %lu missed, %lu late",
+            task, _result->period, _result->runs, _result->min, _result->max,
+            _result->runs ? _result->sum / _result->runs : 0, _result->max - _result->min,
+            _result->missed, _result->late);
+        TEST_MESSAGE(message);
+
+        // Scale the bars to the largest bin
+        unsigned long _largest = 1;
+        for (unsigned char bin = 0; bin < BENCH_BINS; bin++)
+            if (_result->bins[bin] > _largest)
+                _largest = _result->bins[bin];
+
+        for (unsigned char bin = 0; bin < BENCH_BINS; bin++)
+        {
+            if (!_result->bins[bin])
+                continue;
+            int _length = sprintf(message, "  %s%4u us |", (bin == BENCH_BINS - 1) ? ">=" : "  ", bin * BENCH_BIN_us);
+            unsigned char _bar = (unsigned char)((_result->bins[bin] * BENCH_BAR + _largest - 1) / _largest);
+            for (unsigned char count = 0; count < _bar; count++)
+                message[_length++] = '#';
+            sprintf(message + _length, " %lu", _result->bins[bin]);
+            TEST_MESSAGE(message);
+        }
+    }
+};
+
+/**
+ * @brief Set the injected execution time of a task.
+ * @param task The number of the task(group).
+ * @param min The shortest execution time in us.
+ * @param max The longest execution time in us.
+ * @param peak The execution time of the rare long runs in us.
+ * @param peak_rate Every n-th run takes the peak time.
+ */
+void bench_SetLoad(unsigned char task, unsigned int min, unsigned int max,
+    unsigned int peak, unsigned int peak_rate)
+{
+    loadBench[task] = (benchLoad_t){min, max, peak, peak_rate};
+};
+
+/**
+ * @brief The periods of the firmware configuration.
+ * TASK0 is the display, it runs with every SysTick while it is busy.
+ */
+const unsigned long periodsBench[BENCH_TASKS] = {
+    SYSTICK_us, TASK1_ms * 1000UL, TASK2_ms * 1000UL, TASK3_ms * 1000UL};
+
+/**
+ * @brief Test the simulation with exactly known execution times.
+ * @details unit test
+ */
+void test_bench_exact(void)
+{
+    // Only TASK1 runs, it starts right at its release, the release at the end is not run anymore
+    const unsigned long periods[BENCH_TASKS] = {0, 1000, 0, 0};
+    bench_SetLoad(TASK1, 100, 100, 0, 0);
+    bench_Run(periods, 100000);
+    TEST_ASSERT_EQUAL_UINT32(99, resultBench[TASK1].runs);
+    TEST_ASSERT_EQUAL_UINT32(0, resultBench[TASK1].max);
+    TEST_ASSERT_EQUAL_UINT32(0, resultBench[TASK1].missed);
+
+    // TASK0 runs every SysTick, but takes longer than that
+    const unsigned long periods_ovf[BENCH_TASKS] = {SYSTICK_us, 0, 0, 0};
+    bench_SetLoad(TASK0, SYSTICK_us + 50, SYSTICK_us + 50, 0, 0);
+    bench_Run(periods_ovf, 100000);
+    TEST_ASSERT_EQUAL_UINT8(1, schedule_overflow());
+    TEST_ASSERT_GREATER_THAN(0, resultBench[TASK0].missed);
+    TEST_ASSERT_GREATER_THAN(0, resultBench[TASK0].late);
+};
+
+/**
+ * @brief Benchmark of the current configuration with the typical load.
+ * @details The execution times are estimates: the display burst is limited
+ * to DISP_BURST_TCNT, the GUI queues a frame and the system task reads the
+ * keys and draws the screen.
+ */
+void test_bench_nominal(void)
+{
+    bench_SetLoad(TASK0, 20, DISP_BURST_TCNT, 0, 0);
+    bench_SetLoad(TASK1, 40, 80, 0, 0);
+    bench_SetLoad(TASK2, 100, 300, 0, 0);
+    bench_SetLoad(TASK3, 50, 400, 0, 0);
+    bench_Run(periodsBench, BENCH_TIME_us);
+    bench_Report("Nominal");
+
+    // Only the display misses slots behind the long runs, the ADC starts within one SysTick
+    for (unsigned char task = TASK1; task < BENCH_TASKS; task++)
+        TEST_ASSERT_EQUAL_UINT32(0, resultBench[task].missed);
+    TEST_ASSERT_LESS_THAN(SYSTICK_us, resultBench[TASK1].max);
+};
+
+/**
+ * @brief Benchmark of the current configuration with rare long runs.
+ * @details Every 10th run of the system task blocks for 12 ms and every
+ * 20th GUI run for 3 ms, e.g. a blocking write or a screen switch in one pass.
+ * The display misses its slots and the ADC starts late, because the
+ * tasks are not preempted.
+ */
+void test_bench_overload(void)
+{
+    bench_SetLoad(TASK0, 20, DISP_BURST_TCNT, 0, 0);
+    bench_SetLoad(TASK1, 40, 80, 0, 0);
+    bench_SetLoad(TASK2, 100, 300, 12000, 10);
+    bench_SetLoad(TASK3, 50, 400, 3000, 20);
+    bench_Run(periodsBench, BENCH_TIME_us);
+    bench_Report("Overload");
+
+    TEST_ASSERT_GREATER_THAN(0, resultBench[TASK0].missed);
+    TEST_ASSERT_GREATER_THAN(SYSTICK_us, resultBench[TASK1].max);
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_exact);
+    RUN_TEST(test_bench_nominal);
+    RUN_TEST(test_bench_overload);
+    return UNITY_END();
+};
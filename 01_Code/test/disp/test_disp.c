@@ -0,0 +1,686 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_disp.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Unit test for the display driver and the GUI of this project.
+ *          The driver runs on the mocked AVR registers, the SPI interrupt
+ *          is triggered by the test. The environment native_polled runs
+ *          the same tests with the polled SPI of DISP_SPI_ISR=0.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <stdio.h>
+#include <sarb.h>
+#include <scheduler.h>
+#include <filter8.h>
+#include <avr/io.h>
+#include "disp.h"
+#include "../mock/st7565.h"
+
+#if !DISP_SPI_ISR
+/*
+ * Without the SPI interrupt the driver polls SPIF in its burst loop.
+ * The accesses of the driver to SPDR and TCNT0 are redirected to the functions
+ * below, so the SPI shifts a byte out while the burst loop keeps running.
+ */
+#define TEST_BURST_STEP_us  4   // Time of one step of the burst loop
+#define TEST_SPI_BYTE_us    16  // Time to shift out one byte: 8 bits at fosc/16
+unsigned char TestTime_us;      // The time since the start of the SysTick
+unsigned char TestSpiEnd_us;    // The time when the byte in SPDR is shifted out
+unsigned char TestSpiActive;    // The SPI is shifting out a byte
+void test_SpiFinish(void);
+
+/**
+ * @brief The driver writes SPDR, which starts the transfer and clears SPIF.
+ * @return The pointer to the mocked SPDR.
+ */
+volatile unsigned char* test_SpiWrite(void)
+{
+    // A byte in flight would be overwritten, the driver has to check SPIF first
+    TEST_ASSERT_EQUAL_UINT8(0, TestSpiActive);
+    SPSR &= ~(1<<SPIF);
+    TestSpiActive = 1;
+    TestSpiEnd_us = TestTime_us + TEST_SPI_BYTE_us;
+    return &SPDR;
+};
+
+/**
+ * @brief The driver reads TCNT0 after every step of the burst loop.
+ * The time advances and the SPI finishes the byte when it is shifted out.
+ * @return The pointer to the mocked TCNT0.
+ */
+volatile unsigned char* test_TimerRead(void)
+{
+    TestTime_us += TEST_BURST_STEP_us;
+    if (TestSpiActive && (TestTime_us >= TestSpiEnd_us))
+        test_SpiFinish();
+    TCNT0 = TestTime_us;
+    return &TCNT0;
+};
+
+#define SPDR    (*test_SpiWrite())
+#define TCNT0   (*test_TimerRead())
+#include "../../src/disp.c"
+#undef SPDR
+#undef TCNT0
+#else
+#include "../../src/disp.c"
+#endif
+#include "../../src/gui.c"
+#include "../mock/st7565.c"
+#include "font.h"
+#include "digit.h"
+
+// ****** Defines ******
+#define TEST_SPI_BYTES_PER_TICK 12  // Bytes the SPI sends in one SysTick: 200 us / 16 us
+#define TEST_TICKS_MAX          5000 // Abort the simulation after this many SysTicks
+#define TEST_FRAME_PATH         ".pio/" // Directory for the frames of the display model
+
+// ****** Variables ******
+ScaleDat_t datScale;    // The scale data for the GUI
+unsigned long SentBytes; // The number of bytes sent by the SPI
+
+// ****** Functions ******
+/**
+ * @brief Copy the scale data, replaces the function of oScale.c.
+ * @param snapshot The pointer to the copy.
+ */
+void scale_GetSnapshot(ScaleDat_t* snapshot)
+{
+    *snapshot = datScale;
+};
+
+/**
+ * @brief Get the current weight, replaces the function of oScale.c.
+ * @return The weight of the scale data.
+ */
+signed int scale_GetWeight(void)
+{
+    return datScale.Weight;
+};
+
+#if DISP_SPI_ISR
+/**
+ * @brief Simulate one SysTick of TASK0 and the SPI sending in the background.
+ */
+void test_Tick(void)
+{
+    run_scheduler();
+    Task_Disp();
+    Task_GUI();
+
+    // Let the SPI finish the bytes it can send until the next tick
+    for (unsigned char count = 0; count < TEST_SPI_BYTES_PER_TICK; count++)
+    {
+        if (!dispTx.active)
+            break;
+        SentBytes++;
+        st7565_Clock();
+        SPI_STC_vect();
+    }
+};
+
+/**
+ * @brief Check whether the SPI still has bytes to send.
+ * @return Returns one while the transmit buffer is sent.
+ */
+unsigned char test_SpiBusy(void)
+{
+    return dispTx.active;
+};
+#else
+/**
+ * @brief The SPI shifted out the byte in SPDR, the display receives it
+ * with the current state of the A0 pin.
+ */
+void test_SpiFinish(void)
+{
+    SentBytes++;
+    st7565_Clock();
+    SPSR |= (1<<SPIF);
+    TestSpiActive = 0;
+};
+
+/**
+ * @brief Simulate one SysTick of TASK0, the SPI sends during the burst of the display task.
+ */
+void test_Tick(void)
+{
+    TestTime_us = 0;
+    run_scheduler();
+    Task_Disp();
+    Task_GUI();
+
+    // The last byte of the burst is shifted out before the next tick
+    if (TestSpiActive)
+        test_SpiFinish();
+};
+
+/**
+ * @brief Check whether the SPI still has bytes to send.
+ * @return Returns one while a byte is shifted out.
+ */
+unsigned char test_SpiBusy(void)
+{
+    return TestSpiActive;
+};
+#endif
+
+/**
+ * @brief Run the SysTicks until the GUI and the display are finished.
+ * @return The number of SysTicks it took.
+ */
+unsigned int test_RunUntilIdle(void)
+{
+    unsigned int ticks = 0;
+    do
+    {
+        test_Tick();
+        ticks++;
+    } while ((taskGUI.command || disp_IsBusy() || test_SpiBusy()) && (ticks < TEST_TICKS_MAX));
+    return ticks;
+};
+
+/**
+ * @brief Initialize the display and the GUI, the static screen is drawn.
+ * @return The number of SysTicks it took.
+ */
+unsigned int test_InitScreen(void)
+{
+    SentBytes = 0;
+    datScale.Weight = 0;
+    datScale.Time   = 0;
+    datScale.SoC    = 0;
+    st7565_Reset();
+    scheduler_init(SYSTICK_us);
+    disp_InitTask(SYSTICK_us);
+    gui_InitTask();
+    return test_RunUntilIdle();
+};
+
+/**
+ * @brief Test the order and the limit of the display command queue.
+ * @details unit test
+ */
+void test_queue(void)
+{
+    // Initialize the display without running it
+    disp_InitTask(SYSTICK_us);
+    TEST_ASSERT_EQUAL_UINT8(DISP_QUEUE_SIZE, disp_QueueFree());
+
+    // Fill the queue
+    for (unsigned char count = 0; count < DISP_QUEUE_SIZE; count++)
+        TEST_ASSERT_EQUAL_UINT8(1, disp_CallByValue(DISP_CMD_LINE_H, count, 0, 0));
+
+    // The queue is full now
+    TEST_ASSERT_EQUAL_UINT8(0, disp_QueueFree());
+    TEST_ASSERT_EQUAL_UINT8(0, disp_CallByValue(DISP_CMD_LINE_H, 0, 0, 0));
+
+    // The commands are started in the order they were queued
+    for (unsigned char count = 0; count < DISP_QUEUE_SIZE; count++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(1, disp_QueueNext());
+        TEST_ASSERT_EQUAL_UINT8(DISP_CMD_LINE_H, taskDisp.command);
+        TEST_ASSERT_EQUAL_UINT8(count, taskDisp.argument[0]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, disp_QueueNext());
+    TEST_ASSERT_EQUAL_UINT8(DISP_QUEUE_SIZE, disp_QueueFree());
+};
+
+/**
+ * @brief Test that the cursor is saved with the queued command.
+ * @details unit test
+ */
+void test_queue_cursor(void)
+{
+    disp_InitTask(SYSTICK_us);
+
+    // Queue two strings with different cursors
+    disp_SetCursorX(1);
+    disp_SetLine(2);
+    disp_CallByReference(DISP_CMD_WRITE_STRING, "a");
+    disp_SetCursorX(3);
+    disp_SetLine(4);
+    disp_CallByReference(DISP_CMD_WRITE_STRING, "b");
+
+    // Each command gets its own cursor
+    disp_QueueNext();
+    TEST_ASSERT_EQUAL_UINT8(DISP_SIZE_COL - 2*FONT_X, datDisp.x);
+    TEST_ASSERT_EQUAL_UINT8(2, datDisp.y);
+    TEST_ASSERT_EQUAL_UINT8('a', *datDisp.string);
+    disp_QueueNext();
+    TEST_ASSERT_EQUAL_UINT8(DISP_SIZE_COL - 4*FONT_X, datDisp.x);
+    TEST_ASSERT_EQUAL_UINT8(4, datDisp.y);
+    TEST_ASSERT_EQUAL_UINT8('b', *datDisp.string);
+};
+
+/**
+ * @brief Test that the GUI queues a whole manual screen at once
+ * and count the SysTicks until it is drawn.
+ * @details unit test
+ */
+void test_manual_screen_ticks(void)
+{
+    char message[64];
+
+    // Draw the static screen first
+    unsigned int ticks = test_InitScreen();
+    TEST_ASSERT_LESS_THAN(TEST_TICKS_MAX, ticks);
+    sprintf(message, "Init screen: %u ticks, %lu bytes", ticks, SentBytes);
+    TEST_MESSAGE(message);
+
+    // Trigger one manual frame, the GUI has to queue it in one pass
+    datScale.Weight = 1234;
+    datScale.Time   = 75;
+    datScale.SoC    = 80;
+    SentBytes = 0;
+    TEST_ASSERT_EQUAL_UINT8(1, GUI_Draw(GUI_SCREEN_MANUAL));
+    Task_GUI();
+    TEST_ASSERT_EQUAL_UINT8(0, taskGUI.command);
+    TEST_ASSERT_EQUAL_UINT8(DISP_QUEUE_SIZE - 3, disp_QueueFree());
+
+    // Count the ticks until the display is finished
+    ticks = test_RunUntilIdle();
+    sprintf(message, "Manual screen: %u ticks, %lu bytes", ticks, SentBytes);
+    TEST_MESSAGE(message);
+
+    // With one byte per tick the frame took 376 ticks
+    TEST_ASSERT_LESS_THAN(100, ticks);
+};
+
+/**
+ * @brief Queue one manual frame and run the display until it is drawn.
+ * @return The number of bytes sent for the frame.
+ */
+unsigned long test_DrawFrame(void)
+{
+    SentBytes = 0;
+    GUI_Draw(GUI_SCREEN_MANUAL);
+    test_RunUntilIdle();
+    return SentBytes;
+};
+
+/**
+ * @brief Test that the values are only sent when they change.
+ * @details unit test
+ */
+void test_steady_frame(void)
+{
+    char message[64];
+    test_InitScreen();
+
+    // The battery string is not in the shadow region: 3 commands + 5 chars * 6 columns
+    const unsigned long battery_bytes = 3 + 5 * FONT_X;
+
+    // The first frame writes the values
+    datScale.Weight = 1234;
+    datScale.Time   = 75;
+    unsigned long first = test_DrawFrame();
+    TEST_ASSERT_GREATER_THAN(battery_bytes, first);
+
+    // A steady frame only sends the battery
+    unsigned long steady = test_DrawFrame();
+    sprintf(message, "First frame: %lu bytes, steady frame: %lu bytes", first, steady);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(battery_bytes, steady);
+
+    // Only the changed digit is sent, at most one address and 2x12 columns
+    datScale.Weight = 1235;
+    unsigned long changed = test_DrawFrame() - battery_bytes;
+    TEST_ASSERT_GREATER_THAN(0, changed);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (3 + DIGIT_X), changed);
+
+    // The shadow contains the last written digit: '5' at the last position
+    unsigned char column = DISP_SIZE_COL - 2*FONT_X - 4*DIGIT_X;
+    for (unsigned char count = 0; count < DIGIT_X; count++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(number['5' - GLYPH_DIGIT_FIRST][2*(DIGIT_X - 1 - count) + 1], shadowDisp[0][column + count]);
+        TEST_ASSERT_EQUAL_UINT8(number['5' - GLYPH_DIGIT_FIRST][2*(DIGIT_X - 1 - count)], shadowDisp[1][column + count]);
+    }
+};
+
+/**
+ * @brief Write a string with one command and run the display until it is finished.
+ * @param cmd The display command for the string.
+ * @param line The line of the string.
+ * @param string The string to write.
+ * @param ticks Is set to the number of SysTicks it took.
+ * @return The number of bytes sent.
+ */
+unsigned long test_WriteString(unsigned char cmd, unsigned char line, char* string, unsigned int* ticks)
+{
+    SentBytes = 0;
+    disp_SetCursorX(1);
+    disp_SetLine(line);
+    disp_CallByReference(cmd, string);
+    *ticks = test_RunUntilIdle();
+    return SentBytes;
+};
+
+/**
+ * @brief Test that the blit writes the same content as the glyph wise writing,
+ * with only one address per page.
+ * @details unit test
+ */
+void test_blit_number(void)
+{
+    char message[96];
+    unsigned char expected[DISP_SHADOW_PAGES][DISP_SIZE_COL];
+    unsigned int ticks_write, ticks_blit;
+    test_InitScreen();
+
+    // Compare the bytes outside of the shadow region
+    unsigned long bytes_write = test_WriteString(DISP_CMD_WRITE_NUMBER, 2, "0123.4", &ticks_write);
+    unsigned long bytes_blit  = test_WriteString(DISP_CMD_BLIT_NUMBER, 2, "0123.4", &ticks_blit);
+    sprintf(message, "\"0123.4\": write %lu bytes %u ticks, blit %lu bytes %u ticks",
+        bytes_write, ticks_write, bytes_blit, ticks_blit);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(6 * 2 * (3 + DIGIT_X), bytes_write);
+    TEST_ASSERT_EQUAL_UINT32(2 * (3 + 6 * DIGIT_X), bytes_blit);
+
+    // Both commands move the cursor the same way
+    unsigned char x_blit = datDisp.x;
+    test_WriteString(DISP_CMD_WRITE_NUMBER, 2, "0123.4", &ticks_write);
+    TEST_ASSERT_EQUAL_UINT8(x_blit, datDisp.x);
+
+    // Both commands write the same content, the shadow contains what was written
+    memset(shadowDisp, 0xAA, sizeof(shadowDisp));
+    test_WriteString(DISP_CMD_WRITE_NUMBER, DISP_SHADOW_PAGE, "0123.4", &ticks_write);
+    memcpy(expected, shadowDisp, sizeof(shadowDisp));
+    memset(shadowDisp, 0xAA, sizeof(shadowDisp));
+    test_WriteString(DISP_CMD_BLIT_NUMBER, DISP_SHADOW_PAGE, "0123.4", &ticks_blit);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, shadowDisp, sizeof(shadowDisp));
+
+    // The same for the character font
+    memset(shadowDisp, 0xAA, sizeof(shadowDisp));
+    test_WriteString(DISP_CMD_WRITE_STRING, DISP_SHADOW_PAGE + 1, "[min] 9%", &ticks_write);
+    memcpy(expected, shadowDisp, sizeof(shadowDisp));
+    memset(shadowDisp, 0xAA, sizeof(shadowDisp));
+    test_WriteString(DISP_CMD_BLIT_STRING, DISP_SHADOW_PAGE + 1, "[min] 9%", &ticks_blit);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, shadowDisp, sizeof(shadowDisp));
+};
+
+/**
+ * @brief Test that the generated glyph tables match the fonts.
+ * @details unit test
+ */
+void test_glyph_tables(void)
+{
+    // The characters are reversed, characters outside of the subset are blank
+    for (unsigned int character = 0; character < 256; character++)
+    {
+        const unsigned char* glyph = disp_GetCharGlyph(character);
+        unsigned char used = (character >= GLYPH_FONT_FIRST) && (character <= GLYPH_FONT_LAST)
+            && glyph_font_index[character - GLYPH_FONT_FIRST];
+        for (unsigned char count = 0; count < FONT_X; count++)
+            TEST_ASSERT_EQUAL_UINT8(used ? font[character][FONT_X - 1 - count] : 0, glyph[count]);
+    }
+
+    // The digits are split into the rows and reversed
+    for (unsigned char digit = 0; digit < GLYPH_DIGIT_COUNT; digit++)
+        for (unsigned char count = 0; count < DIGIT_X; count++)
+        {
+            TEST_ASSERT_EQUAL_UINT8(number[digit][2*(DIGIT_X - 1 - count)], glyph_digit[digit][0][count]);
+            TEST_ASSERT_EQUAL_UINT8(number[digit][2*(DIGIT_X - 1 - count) + 1], glyph_digit[digit][1][count]);
+        }
+};
+
+// ****** Main ******
+/**
+ * @brief Test the plotted columns of the strip chart.
+ * @details unit test
+ */
+void test_plot_column(void)
+{
+    // Draw the static screen
+    test_InitScreen();
+
+    // Plot a sample into the shadow region, so the written bytes can be checked
+    SentBytes = 0;
+    TEST_ASSERT_EQUAL_UINT8(1, disp_CallByValue(DISP_CMD_PLOT_COLUMN, 100,
+        (DISP_SHADOW_PAGE << 4) | (DISP_SHADOW_PAGE + 1), (9 << 4) | 3));
+    test_RunUntilIdle();
+
+    // Address and two columns per page
+    TEST_ASSERT_EQUAL_UINT32(2 * 5, SentBytes);
+
+    // Pixels 3..7 are the lower 5 rows of the last page, 8..9 the lower 2 of the first
+    TEST_ASSERT_EQUAL_HEX8(0x00, shadowDisp[1][99]);
+    TEST_ASSERT_EQUAL_HEX8(0x1F, shadowDisp[1][100]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, shadowDisp[0][99]);
+    TEST_ASSERT_EQUAL_HEX8(0xC0, shadowDisp[0][100]);
+
+    // A blank sample clears the column
+    TEST_ASSERT_EQUAL_UINT8(1, disp_CallByValue(DISP_CMD_PLOT_COLUMN, 101,
+        (DISP_SHADOW_PAGE << 4) | (DISP_SHADOW_PAGE + 1), DISP_PLOT_BLANK));
+    test_RunUntilIdle();
+    TEST_ASSERT_EQUAL_HEX8(0x00, shadowDisp[1][100]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, shadowDisp[0][100]);
+};
+
+/**
+ * @brief Test that the weight graph advances one column per sample.
+ * @details unit test
+ */
+void test_weight_graph(void)
+{
+    // Draw the static screen, the first sample is plotted right away
+    test_InitScreen();
+    TEST_ASSERT_EQUAL_UINT8(GUI_GRAPH_COL_LAST - 1, graphGUI.column);
+
+    // The next sample follows after the sample period
+    datScale.Weight = GUI_GRAPH_FULL_SCALE / 2;
+    for (unsigned long count = 0; count < GUI_GRAPH_TICKS; count++)
+        test_Tick();
+    TEST_ASSERT_EQUAL_UINT8(GUI_GRAPH_COL_LAST - 2, graphGUI.column);
+    TEST_ASSERT_EQUAL_UINT8(GUI_GRAPH_HEIGHT / 2, graphGUI.pixel);
+
+    // The graph wraps around at the end
+    graphGUI.column = GUI_GRAPH_COL_FIRST;
+    graphGUI.stamp = get_ticks() + 1;
+    test_Tick();
+    TEST_ASSERT_EQUAL_UINT8(GUI_GRAPH_COL_LAST, graphGUI.column);
+
+    // Additional runs of the GUI task within the period do not add samples
+    Task_GUI();
+    test_Tick();
+    TEST_ASSERT_EQUAL_UINT8(GUI_GRAPH_COL_LAST, graphGUI.column);
+    TEST_ASSERT_EQUAL_UINT16(get_ticks() + GUI_GRAPH_TICKS - 1, graphGUI.stamp);
+};
+
+/**
+ * @brief Test the filled rectangle and the clearing of the whole display.
+ * @details unit test
+ */
+void test_fill_rect(void)
+{
+    // Draw the static screen
+    test_InitScreen();
+
+    // Fill a part of the shadow region, the neighbours stay unchanged
+    unsigned char left = shadowDisp[0][9];
+    unsigned char right = shadowDisp[1][20];
+    unsigned char line = queueDisp.y;
+    SentBytes = 0;
+    TEST_ASSERT_EQUAL_UINT8(1, disp_CallFillRect(DISP_SHADOW_PAGE, DISP_SHADOW_PAGE + 1, 10, 20, 0xA5));
+    test_RunUntilIdle();
+
+    // The pattern does not change the line of the cursor
+    TEST_ASSERT_EQUAL_UINT8(line, datDisp.y);
+
+    // One address setup and the columns per page
+    TEST_ASSERT_EQUAL_UINT32(2 * (3 + 10), SentBytes);
+    TEST_ASSERT_EQUAL_HEX8(left, shadowDisp[0][9]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, shadowDisp[0][10]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, shadowDisp[1][19]);
+    TEST_ASSERT_EQUAL_HEX8(right, shadowDisp[1][20]);
+
+    // The clear command fills the whole display RAM
+    SentBytes = 0;
+    TEST_ASSERT_EQUAL_UINT8(1, disp_CallByValue(DISP_CMD_CLEAR, 0, 0, 0));
+    test_RunUntilIdle();
+    TEST_ASSERT_EQUAL_UINT32(DISP_SIZE_PAGE * (3 + DISP_SIZE_COL), SentBytes);
+    TEST_ASSERT_EQUAL_HEX8(0x00, shadowDisp[0][10]);
+};
+
+/**
+ * @brief Test the time it takes to switch back to the manual screen.
+ * @details unit test
+ */
+void test_screen_switch(void)
+{
+    char message[64];
+
+    // Draw the static screen and the first frame
+    test_InitScreen();
+    GUI_Draw(GUI_SCREEN_MANUAL);
+    test_RunUntilIdle();
+
+    // Switch to the manual screen again
+    SentBytes = 0;
+    GUI_Draw(GUI_CMD_INIT);
+    unsigned int ticks = test_RunUntilIdle();
+    sprintf(message, "Screen switch: %u ticks, %lu bytes", ticks, SentBytes);
+    TEST_MESSAGE(message);
+
+    // Without the full clear the switch takes less than 15 ms
+    TEST_ASSERT_LESS_THAN(15000 / SYSTICK_us, ticks);
+};
+
+/**
+ * @brief Test the frames reconstructed by the display model.
+ * @details unit test
+ */
+void test_display_model(void)
+{
+    char message[64];
+
+    // The whole display RAM is cleared and the controller is configured
+    test_InitScreen();
+    TEST_ASSERT_EQUAL_UINT32(SentBytes, st7565_EndFrame());
+    TEST_ASSERT_EQUAL_UINT8(1, st7565.on);
+    TEST_ASSERT_EQUAL_UINT8(0, st7565.start);
+    TEST_ASSERT_EQUAL_UINT8(0x05, st7565.volume);
+    TEST_ASSERT_EQUAL_UINT8(ST7565_NEXT_NONE, st7565.next);
+    TEST_ASSERT_EQUAL_HEX8(0x00, st7565.ram[3][0]);
+
+    // The horizontal line below the header and the vertical line in the middle
+    for (unsigned char x = 0; x < ST7565_WIDTH; x++)
+        TEST_ASSERT_EQUAL_UINT8(1, st7565_GetPixel(x, 8));
+    for (unsigned char y = 8; y < ST7565_HEIGHT; y++)
+        TEST_ASSERT_EQUAL_UINT8(1, st7565_GetPixel(ST7565_WIDTH - 1 - 64, y));
+
+    // Draw a frame, the shadow has to match the display RAM
+    datScale.Weight = 1234;
+    datScale.Time   = 75;
+    datScale.SoC    = 80;
+    unsigned long bytes = test_DrawFrame();
+    TEST_ASSERT_EQUAL_UINT32(bytes, st7565_EndFrame());
+    for (unsigned char page = 0; page < DISP_SHADOW_PAGES; page++)
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(shadowDisp[page], st7565.ram[DISP_SHADOW_PAGE + page], DISP_SIZE_COL);
+    st7565_DumpPBM(TEST_FRAME_PATH "test_disp_manual.pbm");
+
+    // The steady frame only changes the display RAM where the battery is
+    unsigned char expected[ST7565_PAGES][ST7565_COLUMNS];
+    memcpy(expected, st7565.ram, sizeof(expected));
+    bytes = test_DrawFrame();
+    sprintf(message, "Display model: steady frame %lu bytes", st7565_EndFrame());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, st7565.ram, sizeof(expected));
+
+    // The glyph wise writing and the blit render the same frame
+    unsigned int ticks;
+    disp_CallFillRect(2, 3, 0, DISP_SIZE_COL, 0x00);
+    test_RunUntilIdle();
+    test_WriteString(DISP_CMD_WRITE_NUMBER, 2, "0123.4", &ticks);
+    memcpy(expected, st7565.ram, sizeof(expected));
+    disp_CallFillRect(2, 3, 0, DISP_SIZE_COL, 0x00);
+    test_RunUntilIdle();
+    test_WriteString(DISP_CMD_BLIT_NUMBER, 2, "0123.4", &ticks);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, st7565.ram, sizeof(expected));
+};
+
+/**
+ * @brief Test the latency from the sample to the finished weight frame.
+ * @details unit test
+ */
+void test_latency(void)
+{
+    char message[96];
+    unsigned int stamp_adc = 0;
+    test_InitScreen();
+    disp_ResetLatency();
+
+    // Run the tasks with their schedules: ADC every 10 ms with an offset, SYS every 200 ms
+    const unsigned int ticks_adc = TASK1_ms * 1000 / SYSTICK_us;
+    const unsigned int ticks_sys = TASK2_ms * 1000 / SYSTICK_us;
+    for (unsigned int tick = 1; tick <= 10 * ticks_sys + ticks_adc; tick++)
+    {
+        test_Tick();
+        if ((tick % ticks_adc) == 17)
+            stamp_adc = get_ticks();
+        if (!(tick % ticks_sys) && (tick <= 10 * ticks_sys))
+        {
+            datScale.Weight = tick % 2000;
+            datScale.Stamp = stamp_adc;
+            if (!((tick / ticks_sys) % GUI_DRAW_RATE))
+                GUI_Draw(GUI_SCREEN_MANUAL);
+        }
+    }
+
+    // The sample is up to one ADC period old, then the frame needs a few ticks
+    dispLatency_t* latency = disp_GetLatency();
+    sprintf(message, "Latency: min %u, max %u, mean %u ticks of %u us, %u frames",
+        latency->min, latency->max, disp_GetLatencyMean(), SYSTICK_us, latency->count);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT16(10 / GUI_DRAW_RATE, latency->count);
+    TEST_ASSERT_GREATER_THAN(0, latency->min);
+    TEST_ASSERT_LESS_OR_EQUAL(latency->max, latency->min);
+    TEST_ASSERT_LESS_THAN(ticks_adc + 25, latency->max);
+
+    // The reset clears the statistics
+    disp_ResetLatency();
+    TEST_ASSERT_EQUAL_UINT16(0, disp_GetLatency()->count);
+    TEST_ASSERT_EQUAL_UINT16(0, disp_GetLatencyMean());
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    scheduler_init(SYSTICK_us);
+    RUN_TEST(test_queue);
+    RUN_TEST(test_queue_cursor);
+    RUN_TEST(test_manual_screen_ticks);
+    RUN_TEST(test_steady_frame);
+    RUN_TEST(test_blit_number);
+    RUN_TEST(test_glyph_tables);
+    RUN_TEST(test_plot_column);
+    RUN_TEST(test_weight_graph);
+    RUN_TEST(test_fill_rect);
+    RUN_TEST(test_screen_switch);
+    RUN_TEST(test_display_model);
+    RUN_TEST(test_latency);
+    UNITY_END();
+};
@@ -0,0 +1,349 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_filter8.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Unit test of the biquad filters of the filter library and of
+ *          the initializers which are calculated at compile time.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <filter8.h>
+
+// ****** Defines ******
+#define TEST_FS         100     // Sampling frequency of the filtered ADC values in Hz
+#define TEST_STEP       10000   // Amplitude of the step responses
+#define TEST_BENCH_COUNT 10000000UL // Samples which are filtered in the benchmark
+
+// ****** Functions ******
+
+/**
+ * @brief Get the step response of a biquad.
+ * @param p_Biquad The biquad.
+ * @param Step The amplitude of the step.
+ * @param Samples The number of samples of the response.
+ * @param Max Returns the largest output.
+ * @return The last output.
+ */
+signed int test_Step(Biquad_t* p_Biquad, signed int Step, unsigned int Samples, signed int* Max)
+{
+    signed int _y = 0;
+    *Max = -32768;
+    for (unsigned int sample = 0; sample < Samples; sample++)
+    {
+        _y = ApplyBiquad(p_Biquad, Step);
+        if (_y > *Max)
+            *Max = _y;
+    }
+    return _y;
+};
+
+/**
+ * @brief Get the amplitude of a settled sine at the output of a biquad.
+ * @details The amplitude is calculated from the RMS value, the samples
+ * do not hit the peaks of the sine.
+ * @param p_Biquad The biquad.
+ * @param Fs [Hz] The sampling frequency.
+ * @param F [Hz] The frequency of the sine, an integer number of periods fits into 1 s.
+ * @param Amplitude The amplitude of the input.
+ * @return The amplitude of the output after settling.
+ */
+signed int test_Sine(Biquad_t* p_Biquad, unsigned int Fs, float F, signed int Amplitude)
+{
+    double _sum = 0;
+    for (unsigned int sample = 0; sample < 40 * Fs; sample++)
+    {
+        float _x = Amplitude * sinf(2.0f * (float)M_PI * F * sample / Fs);
+        signed int _y = ApplyBiquad(p_Biquad, (signed int)lroundf(_x));
+        if (sample >= 20 * Fs)
+            _sum += (double)_y * _y;
+    }
+    return (signed int)lround(sqrt(2.0 * _sum / (20 * Fs)));
+};
+
+/**
+ * @brief Test the low-pass filters.
+ * @details unit test
+ */
+void test_lowpass(void)
+{
+    Biquad_t filter;
+    signed int max;
+
+    // Butterworth: The step overshoots by 4 % and settles exactly
+    TEST_ASSERT_EQUAL_UINT8(1, CreateButterworthLP(&filter, TEST_FS, 2000, 14));
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, test_Step(&filter, TEST_STEP, 500, &max));
+    TEST_ASSERT_INT16_WITHIN(TEST_STEP / 100, TEST_STEP * 1043L / 1000, max);
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, GetBiquad(&filter));
+
+    // -3 dB at the corner frequency
+    CreateButterworthLP(&filter, TEST_FS, 2000, 14);
+    TEST_ASSERT_INT16_WITHIN(100, 7071, test_Sine(&filter, TEST_FS, 2.0f, 10000));
+
+    // Critically damped: No overshoot and -6 dB at the corner frequency
+    TEST_ASSERT_EQUAL_UINT8(1, CreateCriticalLP(&filter, TEST_FS, 2000, 14));
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, test_Step(&filter, TEST_STEP, 500, &max));
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, max);
+    CreateCriticalLP(&filter, TEST_FS, 2000, 14);
+    TEST_ASSERT_INT16_WITHIN(100, 5000, test_Sine(&filter, TEST_FS, 2.0f, 10000));
+
+    // A low corner frequency still settles exactly, the truncation is fed back
+    TEST_ASSERT_EQUAL_UINT8(1, CreateButterworthLP(&filter, TEST_FS, 300, 14));
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, test_Step(&filter, TEST_STEP, 3000, &max));
+
+    // Invalid corner frequencies
+    TEST_ASSERT_EQUAL_UINT8(0, CreateButterworthLP(&filter, TEST_FS, 0, 14));
+    TEST_ASSERT_EQUAL_UINT8(0, CreateButterworthLP(&filter, TEST_FS, 30000, 14));
+    TEST_ASSERT_EQUAL_UINT8(0, CreateButterworthLP(&filter, TEST_FS, 1, 14));
+};
+
+/**
+ * @brief Test the notch filter.
+ * @details unit test
+ */
+void test_notch(void)
+{
+    Biquad_t filter;
+    signed int max;
+
+    // 50 Hz notch for the oversampled ADC at 1 kHz, DC passes exactly
+    TEST_ASSERT_EQUAL_UINT8(1, CreateNotch(&filter, 1000, 50000, 500, 13));
+    TEST_ASSERT_EQUAL_INT16(8000, test_Step(&filter, 8000, 500, &max));
+
+    // The notch frequency is attenuated by more than 40 dB, other frequencies pass
+    CreateNotch(&filter, 1000, 50000, 500, 13);
+    TEST_ASSERT_LESS_THAN(40, test_Sine(&filter, 1000, 50.0f, 4000));
+    CreateNotch(&filter, 1000, 50000, 500, 13);
+    TEST_ASSERT_INT16_WITHIN(40, 4000, test_Sine(&filter, 1000, 5.0f, 4000));
+    CreateNotch(&filter, 1000, 50000, 500, 13);
+    TEST_ASSERT_INT16_WITHIN(40, 4000, test_Sine(&filter, 1000, 200.0f, 4000));
+};
+
+/**
+ * @brief Test the overflow analysis with the worst case input.
+ * @details unit test
+ */
+void test_overflow(void)
+{
+    Biquad_t filter;
+
+    // The gain bound limits the input bits
+    TEST_ASSERT_EQUAL_UINT8(1, CreateButterworthLP(&filter, TEST_FS, 25000, 14));
+    TEST_ASSERT_EQUAL_UINT8(0, CreateButterworthLP(&filter, TEST_FS, 25000, 15));
+    TEST_ASSERT_EQUAL_UINT8(1, CreateNotch(&filter, TEST_FS, 10000, 100, 13));
+    TEST_ASSERT_EQUAL_UINT8(0, CreateNotch(&filter, TEST_FS, 10000, 100, 14));
+
+    // Coefficients with a too large sum for the accumulator
+    const signed int b[3] = {32767, -32768, 32767};
+    const signed int a[2] = {-32768, 16383};
+    TEST_ASSERT_EQUAL_UINT8(1, CreateBiquad(&filter, b, a, 12, 4));
+    TEST_ASSERT_EQUAL_UINT8(0, CreateBiquad(&filter, b, a, 14, 4));
+
+    // The worst case input follows the sign of the impulse response of the notch,
+    // the output reaches the L1 norm without an overflow
+    float h[400];
+    float x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    CreateNotch(&filter, TEST_FS, 10000, 100, 13);
+    for (unsigned int n = 0; n < 400; n++)
+    {
+        float _x = n ? 0.0f : 1.0f;
+        h[n] = (filter.b[0] * _x + filter.b[1] * x1 + filter.b[2] * x2
+            - filter.a[0] * y1 - filter.a[1] * y2) / BIQUAD_ONE;
+        x2 = x1; x1 = _x; y2 = y1; y1 = h[n];
+    }
+    signed int _y = 0;
+    float _l1 = 0;
+    for (unsigned int n = 0; n < 400; n++)
+    {
+        _l1 += fabsf(h[399 - n]);
+        _y = ApplyBiquad(&filter, (h[399 - n] < 0) ? -8191 : 8191);
+    }
+    TEST_ASSERT_LESS_THAN(BIQUAD_GAIN_NOTCH * 8192 / 4, _y);
+    TEST_ASSERT_INT16_WITHIN(8, (signed int)(_l1 * 8191), _y);
+};
+
+/**
+ * @brief Test cascaded sections.
+ * @details unit test
+ */
+void test_cascade(void)
+{
+    Biquad_t sections[2];
+    signed int y = 0;
+
+    // Two critically damped sections: 4th order, still without overshoot
+    TEST_ASSERT_EQUAL_UINT8(1, CreateCriticalLP(&sections[0], TEST_FS, 5000, 14));
+    TEST_ASSERT_EQUAL_UINT8(1, CreateCriticalLP(&sections[1], TEST_FS, 5000, 14));
+    for (unsigned int sample = 0; sample < 300; sample++)
+    {
+        y = ApplyBiquadCascade(sections, 2, TEST_STEP);
+        TEST_ASSERT_LESS_THAN(TEST_STEP + 1, y);
+    }
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, y);
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, GetBiquad(&sections[1]));
+
+    // The cascade is steeper than one section
+    Biquad_t single;
+    CreateCriticalLP(&single, TEST_FS, 5000, 14);
+    CreateCriticalLP(&sections[0], TEST_FS, 5000, 14);
+    CreateCriticalLP(&sections[1], TEST_FS, 5000, 14);
+    signed int max_single = 0;
+    signed int max_cascade = 0;
+    for (unsigned int sample = 0; sample < 1000; sample++)
+    {
+        signed int _x = (signed int)lroundf(8000.0f * sinf(2.0f * (float)M_PI * 20.0f * sample / TEST_FS));
+        signed int _single = ApplyBiquad(&single, _x);
+        signed int _cascade = ApplyBiquadCascade(sections, 2, _x);
+        if ((sample > 500) && (abs(_single) > max_single))
+            max_single = abs(_single);
+        if ((sample > 500) && (abs(_cascade) > max_cascade))
+            max_cascade = abs(_cascade);
+    }
+    TEST_ASSERT_LESS_THAN(max_single / 4, max_cascade);
+};
+
+/**
+ * @brief Compare two PT1 filters.
+ * @param Expected The filter of CreatePT1().
+ * @param Actual The filter of PT1_INIT().
+ */
+void test_ComparePT1(IIR_Filter_t* Expected, IIR_Filter_t* Actual)
+{
+    TEST_ASSERT_EQUAL_UINT32(Expected->a[0], Actual->a[0]);
+    TEST_ASSERT_EQUAL_UINT32(Expected->a[1], Actual->a[1]);
+    TEST_ASSERT_EQUAL_UINT32(Expected->b[0], Actual->b[0]);
+    TEST_ASSERT_EQUAL_UINT8(Expected->ScaleBits, Actual->ScaleBits);
+    TEST_ASSERT_EQUAL_UINT8(Expected->ExtraBits, Actual->ExtraBits);
+};
+
+/**
+ * @brief Compare two biquads.
+ * @param Expected The biquad of a Create function.
+ * @param Actual The biquad of BIQUAD_INIT().
+ */
+void test_CompareBiquad(Biquad_t* Expected, Biquad_t* Actual)
+{
+    for (unsigned char coefficient = 0; coefficient < 3; coefficient++)
+        TEST_ASSERT_EQUAL_INT16(Expected->b[coefficient], Actual->b[coefficient]);
+    TEST_ASSERT_EQUAL_INT16(Expected->a[0], Actual->a[0]);
+    TEST_ASSERT_EQUAL_INT16(Expected->a[1], Actual->a[1]);
+};
+
+/**
+ * @brief Test that the initializers give the same filters as the Create functions.
+ * @details unit test
+ */
+void test_init(void)
+{
+    // The PT1 filters of the ADC with and without oversampling
+    IIR_Filter_t pt1_12 = PT1_INIT(100, 100, 300, 12, 4);
+    IIR_Filter_t pt1_14 = PT1_INIT(100, 40, 300, 14, 2);
+    IIR_Filter_t pt1_fast = PT1_INIT(1000, 32, 50, 14, 2);
+    IIR_Filter_t pt1;
+    CreatePT1(&pt1, 100, 100, 300, 12, 4);
+    test_ComparePT1(&pt1, &pt1_12);
+    CreatePT1(&pt1, 100, 40, 300, 14, 2);
+    test_ComparePT1(&pt1, &pt1_14);
+    CreatePT1(&pt1, 1000, 32, 50, 14, 2);
+    test_ComparePT1(&pt1, &pt1_fast);
+
+    // The reset keeps the coefficients
+    ApplyPT1(&pt1_12, 1000);
+    ResetIIR(&pt1_12);
+    TEST_ASSERT_EQUAL_UINT16(0, GetIIR(&pt1_12));
+    CreatePT1(&pt1, 100, 100, 300, 12, 4);
+    test_ComparePT1(&pt1, &pt1_12);
+
+    // The decimators for all rates
+    const Decimator_t decimators[] = {
+        DECIMATOR_INIT(1, 12), DECIMATOR_INIT(10, 12), DECIMATOR_INIT(16, 12), DECIMATOR_INIT(17, 12),
+        DECIMATOR_INIT(50, 12), DECIMATOR_INIT(255, 12), DECIMATOR_INIT(2, 16), DECIMATOR_INIT(255, 16)};
+    const unsigned char rates[] = {1, 10, 16, 17, 50, 255, 2, 255};
+    const unsigned char bits[] = {12, 12, 12, 12, 12, 12, 16, 16};
+    for (unsigned char decimator = 0; decimator < sizeof(rates); decimator++)
+    {
+        Decimator_t _expected;
+        CreateDecimator(&_expected, rates[decimator], bits[decimator]);
+        TEST_ASSERT_EQUAL_UINT8(_expected.Rate, decimators[decimator].Rate);
+        TEST_ASSERT_EQUAL_UINT8(_expected.Shift, decimators[decimator].Shift);
+    }
+
+    // The biquads of 06_Simulation/GenerateBiquads.py:
+    // --filter LOWPASS_2HZ:butterworth:100:2 --filter CRITICAL_5HZ:critical:100:5
+    // --filter NOTCH_50HZ:notch:1000:50:5 --bits 13
+    Biquad_t lowpass = BIQUAD_INIT(59, 119, 59, -29863, 13716);
+    Biquad_t critical = BIQUAD_INIT(306, 614, 306, -23807, 8649);
+    Biquad_t notch = BIQUAD_INIT(15893, -30230, 15893, -30230, 15402);
+    Biquad_t biquad;
+    CreateButterworthLP(&biquad, 100, 2000, 13);
+    test_CompareBiquad(&biquad, &lowpass);
+    CreateCriticalLP(&biquad, 100, 5000, 13);
+    test_CompareBiquad(&biquad, &critical);
+    CreateNotch(&biquad, 1000, 50000, 500, 13);
+    test_CompareBiquad(&biquad, &notch);
+
+    // The initialized biquad filters without a Create function
+    signed int max;
+    TEST_ASSERT_EQUAL_INT16(TEST_STEP, test_Step(&lowpass, TEST_STEP, 500, &max));
+    ResetBiquad(&lowpass);
+    TEST_ASSERT_EQUAL_INT16(0, GetBiquad(&lowpass));
+};
+
+/**
+ * @brief Measure the time of one biquad section on the host.
+ * @details benchmark
+ */
+void test_benchmark(void)
+{
+    Biquad_t filter;
+    signed long sum = 0;
+    CreateButterworthLP(&filter, TEST_FS, 2000, 14);
+
+    clock_t start = clock();
+    for (unsigned long count = 0; count < TEST_BENCH_COUNT; count++)
+        sum += ApplyBiquad(&filter, (signed int)(count & 0x1FFF));
+    clock_t end = clock();
+
+    // The sum keeps the loop from being removed
+    char message[96];
+    double ns = ((double)(end - start) * 1e9) / CLOCKS_PER_SEC / TEST_BENCH_COUNT;
+    sprintf(message, "Host: %.2f ns per biquad section (checksum %ld)", ns, sum);
+    TEST_MESSAGE(message);
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lowpass);
+    RUN_TEST(test_notch);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_cascade);
+    RUN_TEST(test_init);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+};
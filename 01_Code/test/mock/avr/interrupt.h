@@ -0,0 +1,41 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    interrupt.h
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Mock of the AVR interrupt handling for the native unit tests.
+ *          An ISR becomes a normal function with the name of the vector,
+ *          so the tests can trigger the interrupts by calling it.
+ ******************************************************************************
+ */
+#ifndef MOCK_AVR_INTERRUPT_H_
+#define MOCK_AVR_INTERRUPT_H_
+
+// ****** Includes ******
+#include <avr/io.h>
+
+// ****** Defines ******
+#define ISR(vector) void vector(void)
+#define sei()       (SREG |= 0x80)
+#define cli()       (SREG &= ~0x80)
+#endif
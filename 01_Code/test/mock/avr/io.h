@@ -0,0 +1,152 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    io.h
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Mock of the AVR register definitions for the native unit tests.
+ *          The registers are plain variables, so the tests can read what the
+ *          firmware writes and inject what the hardware would set.
+ ******************************************************************************
+ */
+#ifndef MOCK_AVR_IO_H_
+#define MOCK_AVR_IO_H_
+
+// ****** Defines ******
+#define F_CPU   8000000UL   // The clock of the oScale
+#define __flash             // Flash constants are normal constants on the host
+
+// The registers are weak, so every test unit can include this header
+#define MOCK_REGISTER(name) volatile unsigned char name __attribute__((weak))
+
+// ****** Registers ******
+// Ports
+MOCK_REGISTER(DDRB);
+MOCK_REGISTER(PORTB);
+MOCK_REGISTER(PINB);
+MOCK_REGISTER(DDRC);
+MOCK_REGISTER(PORTC);
+MOCK_REGISTER(PINC);
+MOCK_REGISTER(DDRD);
+MOCK_REGISTER(PORTD);
+MOCK_REGISTER(PIND);
+
+// SPI
+MOCK_REGISTER(SPCR);
+MOCK_REGISTER(SPSR);
+MOCK_REGISTER(SPDR);
+
+// Timer 0
+MOCK_REGISTER(TCCR0A);
+MOCK_REGISTER(TCCR0B);
+MOCK_REGISTER(TCNT0);
+MOCK_REGISTER(OCR0A);
+MOCK_REGISTER(OCR0B);
+MOCK_REGISTER(TIMSK0);
+MOCK_REGISTER(TIFR0);
+
+// ADC
+MOCK_REGISTER(ADMUX);
+MOCK_REGISTER(ADCSRA);
+MOCK_REGISTER(ADCH);
+MOCK_REGISTER(DIDR0);
+
+// Pin change interrupts
+MOCK_REGISTER(PCICR);
+MOCK_REGISTER(PCIFR);
+MOCK_REGISTER(PCMSK2);
+
+// Core
+MOCK_REGISTER(SREG);
+MOCK_REGISTER(SMCR);
+
+// ****** Bits ******
+// Ports
+#define PB0     0
+#define PB1     1
+#define PB2     2
+#define PB3     3
+#define PB4     4
+#define PB5     5
+#define PC0     0
+#define PC1     1
+#define PD0     0
+#define PD1     1
+#define PD2     2
+#define PD3     3
+#define PD4     4
+#define PD5     5
+#define PD6     6
+#define PD7     7
+
+// SPI
+#define SPR0    0
+#define SPR1    1
+#define CPHA    2
+#define CPOL    3
+#define MSTR    4
+#define DORD    5
+#define SPE     6
+#define SPIE    7
+#define SPI2X   0
+#define WCOL    6
+#define SPIF    7
+
+// Timer 0
+#define WGM00   0
+#define WGM01   1
+#define CS00    0
+#define CS01    1
+#define CS02    2
+#define TOIE0   0
+#define OCIE0A  1
+#define OCIE0B  2
+#define TOV0    0
+#define OCF0A   1
+#define OCF0B   2
+
+// ADC
+#define ADLAR   5
+#define ADC0D   0
+#define ADPS0   0
+#define ADPS1   1
+#define ADPS2   2
+#define ADIE    3
+#define ADIF    4
+#define ADSC    6
+#define ADEN    7
+
+// Pin change interrupts
+#define PCIE2   2
+#define PCIF2   2
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+
+// Core
+#define SE      0
+#define SM0     1
+#define SM1     2
+#define SM2     3
+#endif
@@ -0,0 +1,216 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    st7565.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Model of the ST7565 display controller for the native unit tests.
+ *          The test calls st7565_Clock() whenever the SPI finished a byte,
+ *          the model then reads the byte from SPDR and the state of the
+ *          pins from the mocked ports.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <stdio.h>
+#include <string.h>
+#include "st7565.h"
+
+// ****** Variables ******
+st7565_t st7565; // The state of the display controller
+
+// ****** Functions ******
+/**
+ * @brief Reset the controller like the reset pin does.
+ * The content of the display RAM is random after power up,
+ * the model fills it with a pattern so missing writes are visible.
+ */
+void st7565_Reset(void)
+{
+    memset(&st7565, 0, sizeof(st7565));
+    memset(st7565.ram, 0x55, sizeof(st7565.ram));
+    st7565.volume = 0x20;
+};
+
+/**
+ * @brief Receive one byte from the SPI.
+ * @param byte The received byte.
+ * @param a0 The state of the A0 pin, 0 = command.
+ */
+void st7565_Receive(unsigned char byte, unsigned char a0)
+{
+    st7565.frame++;
+    if (a0)
+    {
+        // Write the data and increment the column address
+        st7565.data++;
+        if ((st7565.page < ST7565_PAGES) && (st7565.column < ST7565_COLUMNS))
+            st7565.ram[st7565.page][st7565.column] = byte;
+        if (st7565.column < ST7565_COLUMNS)
+            st7565.column++;
+    }
+    else
+    {
+        st7565.commands++;
+        st7565_Command(byte);
+    }
+};
+
+/**
+ * @brief The SPI shifted out the byte in SPDR.
+ * @details The byte is only received when the chip select is low.
+ */
+void st7565_Clock(void)
+{
+    if (!(ST7565_PORT_CS & (1<<ST7565_PIN_CS)))
+        st7565_Receive(SPDR, ST7565_PORT_A0 & (1<<ST7565_PIN_A0));
+};
+
+/**
+ * @brief Decode a command byte.
+ * @param command The received command byte.
+ */
+void st7565_Command(unsigned char command)
+{
+    // The value of a double byte command
+    switch (st7565.next)
+    {
+    case ST7565_NEXT_VOLUME:
+        st7565.volume = command & 0x3F;
+        st7565.next = ST7565_NEXT_NONE;
+        return;
+
+    case ST7565_NEXT_INDICATOR:
+        st7565.indicator = (st7565.indicator & 0x04) | (command & 0x03);
+        st7565.next = ST7565_NEXT_NONE;
+        return;
+
+    case ST7565_NEXT_BOOSTER:
+        st7565.booster = command & 0x03;
+        st7565.next = ST7565_NEXT_NONE;
+        return;
+
+    default:
+        break;
+    }
+
+    // Single byte commands
+    if ((command & 0xF0) == 0x00)
+        st7565.column = (st7565.column & 0xF0) | (command & 0x0F);
+    else if ((command & 0xF0) == 0x10)
+        st7565.column = (st7565.column & 0x0F) | ((command & 0x0F) << 4);
+    else if ((command & 0xF8) == 0x20)
+        st7565.ratio = command & 0x07;
+    else if ((command & 0xF8) == 0x28)
+        st7565.power = command & 0x07;
+    else if ((command & 0xC0) == 0x40)
+        st7565.start = command & 0x3F;
+    else if (command == 0x81)
+        st7565.next = ST7565_NEXT_VOLUME;
+    else if ((command & 0xFE) == 0xA0)
+        st7565.adc = command & 0x01;
+    else if ((command & 0xFE) == 0xA2)
+        st7565.bias = command & 0x01;
+    else if ((command & 0xFE) == 0xA4)
+        st7565.all = command & 0x01;
+    else if ((command & 0xFE) == 0xA6)
+        st7565.reverse = command & 0x01;
+    else if ((command & 0xFE) == 0xAC)
+    {
+        st7565.indicator = (command & 0x01) << 2;
+        st7565.next = ST7565_NEXT_INDICATOR;
+    }
+    else if ((command & 0xFE) == 0xAE)
+        st7565.on = command & 0x01;
+    else if ((command & 0xF0) == 0xB0)
+        st7565.page = command & 0x0F;
+    else if ((command & 0xF0) == 0xC0)
+        st7565.com = (command >> 3) & 0x01;
+    else if (command == 0xE2)
+    {
+        // Internal reset, the display RAM is not affected
+        st7565.column = 0;
+        st7565.page = 0;
+        st7565.start = 0;
+        st7565.com = 0;
+        st7565.volume = 0x20;
+    }
+    else if (command == 0xF8)
+        st7565.next = ST7565_NEXT_BOOSTER;
+};
+
+/**
+ * @brief Get a pixel as it is visible on the panel.
+ * @param x The x-coordinate on the panel, 0 is left.
+ * @param y The y-coordinate on the panel, 0 is on top.
+ * @return Returns 1 when the pixel is dark.
+ */
+unsigned char st7565_GetPixel(unsigned char x, unsigned char y)
+{
+    if (!st7565.on)
+        return 0;
+    if (st7565.all)
+        return 1;
+
+    // Get the RAM line of the COM output
+    unsigned char _line = st7565.com ? (ST7565_HEIGHT - 1 - y) : y;
+    _line = (_line + st7565.start) % ST7565_HEIGHT;
+
+    // Get the RAM column of the segment output
+    unsigned char _segment = ST7565_PANEL_MIRROR ? (ST7565_WIDTH - 1 - x) : x;
+    unsigned char _column = st7565.adc ? (ST7565_COLUMNS - 1 - _segment) : _segment;
+
+    unsigned char _pixel = (st7565.ram[_line / 8][_column] >> (_line % 8)) & 1;
+    return _pixel ^ st7565.reverse;
+};
+
+/**
+ * @brief Mark the end of a frame.
+ * @return The number of bytes which were received for this frame.
+ */
+unsigned long st7565_EndFrame(void)
+{
+    unsigned long _bytes = st7565.frame;
+    st7565.frame = 0;
+    return _bytes;
+};
+
+/**
+ * @brief Write the visible frame to a plain PBM image.
+ * @param path The path of the image file.
+ * @return Returns 1 when the image was written.
+ */
+unsigned char st7565_DumpPBM(const char* path)
+{
+    FILE* _file = fopen(path, "w");
+    if (!_file)
+        return 0;
+
+    fprintf(_file, "P1\n%d %d\n", ST7565_WIDTH, ST7565_HEIGHT);
+    for (unsigned char y = 0; y < ST7565_HEIGHT; y++)
+    {
+        for (unsigned char x = 0; x < ST7565_WIDTH; x++)
+            fputc(st7565_GetPixel(x, y) ? '1' : '0', _file);
+        fputc('\n', _file);
+    }
+    fclose(_file);
+    return 1;
+};
@@ -0,0 +1,92 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    st7565.h
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Model of the ST7565 display controller for the native unit tests.
+ *          The model decodes the bytes the driver shifts out of the mocked
+ *          SPI, keeps the display RAM and renders the visible frame.
+ ******************************************************************************
+ */
+#ifndef MOCK_ST7565_H_
+#define MOCK_ST7565_H_
+
+// ****** Includes ******
+#include <avr/io.h>
+
+// ****** Defines ******
+#define ST7565_COLUMNS      132 // Columns of the display RAM
+#define ST7565_PAGES        8   // Pages of the display RAM, the icon page is not modelled
+#define ST7565_WIDTH        128 // Pixel of the panel in X-Direction
+#define ST7565_HEIGHT       64  // Pixel of the panel in Y-Direction
+
+// The panel of the oScale is connected to the segments in reverse order
+#ifndef ST7565_PANEL_MIRROR
+#define ST7565_PANEL_MIRROR 1
+#endif
+
+// Pins which are sampled with every byte
+#define ST7565_PORT_CS      PORTB   // The port of the chip select
+#define ST7565_PIN_CS       PB2     // Chip select, active low
+#define ST7565_PORT_A0      PORTC   // The port of the A0 pin
+#define ST7565_PIN_A0       PC1     // A0 high = data, A0 low = command
+
+// Double byte commands, the next byte is the value of the register
+#define ST7565_NEXT_NONE    0
+#define ST7565_NEXT_VOLUME  1
+#define ST7565_NEXT_INDICATOR 2
+#define ST7565_NEXT_BOOSTER 3
+
+// ****** Variables ******
+typedef struct  // State of the display controller
+{
+    unsigned char ram[ST7565_PAGES][ST7565_COLUMNS];
+    unsigned char column;       // Column address, increments with every data byte
+    unsigned char page;         // Page address
+    unsigned char start;        // Display start line
+    unsigned char on;           // Display is enabled
+    unsigned char adc;          // Segment driver direction is reversed
+    unsigned char com;          // COM output scan direction is reversed
+    unsigned char reverse;      // Pixels are inverted
+    unsigned char all;          // All pixels are on
+    unsigned char bias;         // LCD bias select
+    unsigned char power;        // Power control mode
+    unsigned char ratio;        // Internal resistor ratio
+    unsigned char volume;       // Electronic volume, the contrast
+    unsigned char indicator;    // Static indicator mode
+    unsigned char booster;      // Booster ratio
+    unsigned char next;         // The next byte belongs to a double byte command
+    unsigned long commands;     // Number of received command bytes
+    unsigned long data;         // Number of received data bytes
+    unsigned long frame;        // Number of received bytes since the last frame
+} st7565_t;
+
+// ****** Functions ******
+void            st7565_Reset            (void);
+void            st7565_Receive          (unsigned char byte, unsigned char a0);
+void            st7565_Clock            (void);
+void            st7565_Command          (unsigned char command);
+unsigned char   st7565_GetPixel         (unsigned char x, unsigned char y);
+unsigned long   st7565_EndFrame         (void);
+unsigned char   st7565_DumpPBM          (const char* path);
+#endif
@@ -0,0 +1,40 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    atomic.h
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Mock of the AVR atomic blocks for the native unit tests.
+ *          The tests run single threaded, so the blocks are executed once.
+ ******************************************************************************
+ */
+#ifndef MOCK_UTIL_ATOMIC_H_
+#define MOCK_UTIL_ATOMIC_H_
+
+// ****** Defines ******
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define NONATOMIC_RESTORESTATE
+#define NONATOMIC_FORCEOFF
+#define ATOMIC_BLOCK(type)      for (unsigned char _done = 0; !_done; _done = 1)
+#define NONATOMIC_BLOCK(type)   for (unsigned char _done = 0; !_done; _done = 1)
+#endif
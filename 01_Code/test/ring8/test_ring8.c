@@ -0,0 +1,244 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_ring8.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Unit test and benchmark of the ring buffer library.
+ *          The stress test runs the producer and the consumer in two threads.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <ring8.h>
+
+// ****** Defines ******
+#define TEST_STRESS_COUNT   200000UL    // Elements which are sent through the ring in the stress test
+#define TEST_BENCH_COUNT    10000000UL  // Elements which are pushed and popped in the benchmark
+
+typedef struct  // Element with several bytes, like a time stamped sample
+{
+    unsigned int value;
+    unsigned int stamp;
+} testSample_t;
+
+RING8_DECLARE(ringByte, unsigned char, 8)
+RING8_DECLARE(ringSample, testSample_t, 4)
+RING8_DECLARE(ringOne, unsigned char, 1)
+RING8_DECLARE(ringStress, unsigned long, 16)
+
+// ****** Variables ******
+ringStress_t StressRing;        // The ring which is shared by the threads
+unsigned long StressErrors;     // Elements which were received out of order
+
+// ****** Functions ******
+
+/**
+ * @brief Test the empty and the full ring.
+ * @details unit test
+ */
+void test_full_empty(void)
+{
+    ringByte_t ring;
+    unsigned char value = 0;
+    ringByte_init(&ring);
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_count(&ring));
+    TEST_ASSERT_EQUAL_UINT8(8, ringByte_free(&ring));
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_pop(&ring, &value));
+    TEST_ASSERT_NULL(ringByte_front(&ring));
+
+    // Fill the ring, the next element is refused
+    for (unsigned char count = 0; count < 8; count++)
+        TEST_ASSERT_EQUAL_UINT8(1, ringByte_push(&ring, count));
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_push(&ring, 8));
+    TEST_ASSERT_EQUAL_UINT8(8, ringByte_count(&ring));
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_free(&ring));
+
+    // The elements come out in order
+    for (unsigned char count = 0; count < 8; count++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(1, ringByte_pop(&ring, &value));
+        TEST_ASSERT_EQUAL_UINT8(count, value);
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_count(&ring));
+
+    // A ring with one element
+    ringOne_t one;
+    ringOne_init(&one);
+    TEST_ASSERT_EQUAL_UINT8(1, ringOne_push(&one, 42));
+    TEST_ASSERT_EQUAL_UINT8(0, ringOne_push(&one, 43));
+    TEST_ASSERT_EQUAL_UINT8(1, ringOne_pop(&one, &value));
+    TEST_ASSERT_EQUAL_UINT8(42, value);
+};
+
+/**
+ * @brief Test that the indices wrap around the byte range.
+ * @details unit test
+ */
+void test_wrap(void)
+{
+    ringByte_t ring;
+    unsigned char value = 0;
+    ringByte_init(&ring);
+
+    // Run the indices around more than once with a partly filled ring
+    for (unsigned int count = 0; count < 3; count++)
+        ringByte_push(&ring, (unsigned char)count);
+    for (unsigned int count = 3; count < 1000; count++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(1, ringByte_push(&ring, (unsigned char)count));
+        TEST_ASSERT_EQUAL_UINT8(1, ringByte_pop(&ring, &value));
+        TEST_ASSERT_EQUAL_UINT8((unsigned char)(count - 3), value);
+        TEST_ASSERT_EQUAL_UINT8(3, ringByte_count(&ring));
+    }
+
+    // The full ring is detected across the wrap
+    ring.head = 254;
+    ring.tail = 254;
+    for (unsigned char count = 0; count < 8; count++)
+        TEST_ASSERT_EQUAL_UINT8(1, ringByte_push(&ring, count));
+    TEST_ASSERT_EQUAL_UINT8(6, ring.head);
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_push(&ring, 8));
+    TEST_ASSERT_EQUAL_UINT8(8, ringByte_count(&ring));
+};
+
+/**
+ * @brief Test a ring of structs and the access in place.
+ * @details unit test
+ */
+void test_struct(void)
+{
+    ringSample_t ring;
+    ringSample_init(&ring);
+    TEST_ASSERT_EQUAL_UINT8(1, ringSample_push(&ring, (testSample_t){0x1234, 7}));
+    TEST_ASSERT_EQUAL_UINT8(1, ringSample_push(&ring, (testSample_t){0x5678, 8}));
+
+    // The oldest element stays in the ring until it is dropped
+    testSample_t* sample = ringSample_front(&ring);
+    TEST_ASSERT_NOT_NULL(sample);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, sample->value);
+    TEST_ASSERT_EQUAL_UINT16(7, sample->stamp);
+    TEST_ASSERT_EQUAL_UINT8(2, ringSample_count(&ring));
+    ringSample_drop(&ring);
+
+    testSample_t copy;
+    TEST_ASSERT_EQUAL_UINT8(1, ringSample_pop(&ring, &copy));
+    TEST_ASSERT_EQUAL_UINT16(0x5678, copy.value);
+    TEST_ASSERT_EQUAL_UINT16(8, copy.stamp);
+    TEST_ASSERT_EQUAL_UINT8(0, ringSample_pop(&ring, &copy));
+};
+
+/**
+ * @brief The producer of the stress test, sends a counting sequence.
+ * @param arg Unused.
+ * @return Always 0.
+ */
+void* test_StressProducer(void* arg)
+{
+    (void)arg;
+    for (unsigned long count = 0; count < TEST_STRESS_COUNT; count++)
+        while (!ringStress_push(&StressRing, count))
+            sched_yield();
+    return 0;
+};
+
+/**
+ * @brief The consumer of the stress test, checks the counting sequence.
+ * @param arg Unused.
+ * @return Always 0.
+ */
+void* test_StressConsumer(void* arg)
+{
+    (void)arg;
+    unsigned long value = 0;
+    for (unsigned long count = 0; count < TEST_STRESS_COUNT; count++)
+    {
+        while (!ringStress_pop(&StressRing, &value))
+            sched_yield();
+        if (value != count)
+            StressErrors++;
+    }
+    return 0;
+};
+
+/**
+ * @brief Test the ring with the producer and the consumer running concurrently.
+ * @details unit test, a waiting side yields, so the test is also fast on a single core.
+ */
+void test_stress(void)
+{
+    pthread_t producer;
+    pthread_t consumer;
+    ringStress_init(&StressRing);
+    StressErrors = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&consumer, 0, test_StressConsumer, 0));
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, 0, test_StressProducer, 0));
+    pthread_join(producer, 0);
+    pthread_join(consumer, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(0, StressErrors);
+    TEST_ASSERT_EQUAL_UINT8(0, ringStress_count(&StressRing));
+};
+
+/**
+ * @brief Measure the time of one push and one pop on the host.
+ * @details benchmark
+ */
+void test_benchmark(void)
+{
+    ringByte_t ring;
+    unsigned char value = 0;
+    unsigned long sum = 0;
+    ringByte_init(&ring);
+
+    clock_t start = clock();
+    for (unsigned long count = 0; count < TEST_BENCH_COUNT; count++)
+    {
+        ringByte_push(&ring, (unsigned char)count);
+        ringByte_pop(&ring, &value);
+        sum += value;
+    }
+    clock_t end = clock();
+
+    // The sum keeps the loop from being removed
+    char message[96];
+    double ns = ((double)(end - start) * 1e9) / CLOCKS_PER_SEC / TEST_BENCH_COUNT;
+    sprintf(message, "Host: %.2f ns per push and pop (checksum %lu)", ns, sum);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT8(0, ringByte_count(&ring));
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_full_empty);
+    RUN_TEST(test_wrap);
+    RUN_TEST(test_struct);
+    RUN_TEST(test_stress);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+};
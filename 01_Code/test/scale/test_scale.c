@@ -0,0 +1,178 @@
+/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2021 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    test_scale.c
+ * @author  SO
+ * @version V1.0.0
+ * @date    17-October-2026
+ * @brief   Unit test for the system task of the oScale.
+ *          The ADC and the GUI are replaced by stubs.
+ ******************************************************************************
+ */
+// ****** Includes ******
+#include <unity.h>
+#include <scheduler.h>
+#include "../../src/oScale.c"
+
+// ****** Variables ******
+unsigned int ValueADC;  // The filtered value of the ADC stub
+unsigned int StampADC;  // The time stamp of the ADC stub
+
+// ****** Functions ******
+/**
+ * @brief Get the filtered value, replaces the function of adc.c.
+ * @return The value of the stub.
+ */
+unsigned int adc_GetValue(void)
+{
+    return ValueADC;
+};
+
+/**
+ * @brief Get the time stamp, replaces the function of adc.c.
+ * @return The time stamp of the stub.
+ */
+unsigned int adc_GetStamp(void)
+{
+    return StampADC;
+};
+
+/**
+ * @brief Trigger the GUI, replaces the function of gui.c.
+ * @param screen The screen to draw.
+ * @return Always 1.
+ */
+unsigned char GUI_Draw(unsigned char screen)
+{
+    (void)screen;
+    return 1;
+};
+
+/**
+ * @brief Initialize the system task in the manual state with zero weight.
+ */
+void test_Init(void)
+{
+    scheduler_init(SYSTICK_us);
+    schedule(TASK2, SYS_TICKS(TASK2_ms * 1000UL));
+    PIND = 0;
+    PCICR = 0;
+    ValueADC = 0x1000;
+    StampADC = 0;
+    temp_timer_enable = 0;
+    scale_InitTask();
+    oScale.State = SYS_STATE_MANUAL;
+};
+
+/**
+ * @brief Run the system task and let the SysTick apply a new schedule.
+ */
+void test_RunSYS(void)
+{
+    Task_SYS();
+    run_scheduler();
+};
+
+/**
+ * @brief Test the snapshot of the scale data.
+ * @details unit test
+ */
+void test_snapshot(void)
+{
+    ScaleDat_t snapshot;
+    test_Init();
+
+    // The system task writes a consistent update
+    ValueADC = 0x1000 - 1234;
+    StampADC = 42;
+    Task_SYS();
+    TEST_ASSERT_EQUAL_UINT8(0, seqScale & 1);
+    TEST_ASSERT_EQUAL_UINT8(1, scale_TryGetSnapshot(&snapshot));
+    TEST_ASSERT_EQUAL_INT16(1234, snapshot.Weight);
+    TEST_ASSERT_EQUAL_UINT16(42, snapshot.Stamp);
+
+    // While the data is written, the reader gets no copy
+    unsigned char sequence = seqScale;
+    scale_BeginWrite();
+    datScale.Weight = 1;
+    TEST_ASSERT_EQUAL_UINT8(0, scale_TryGetSnapshot(&snapshot));
+    TEST_ASSERT_EQUAL_INT16(1234, snapshot.Weight);
+    scale_EndWrite();
+    TEST_ASSERT_EQUAL_UINT8(sequence + 2, seqScale);
+
+    scale_GetSnapshot(&snapshot);
+    TEST_ASSERT_EQUAL_INT16(1, snapshot.Weight);
+};
+
+/**
+ * @brief Test the switch to the low rate profile and back.
+ * @details unit test
+ */
+void test_low_rate(void)
+{
+    const unsigned int full = SYS_TICKS(TASK2_ms * 1000UL);
+    const unsigned int low = SYS_TICKS(TASK2_LOW_ms * 1000UL);
+    test_Init();
+
+    // A stable weight switches to the low rate after SYS_IDLE_s
+    for (unsigned int run = 0; run <= SYS_IDLE_RUNS; run++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(0, oScale.RateLow);
+        ValueADC = 0x1000 - (run & 3);
+        test_RunSYS();
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, oScale.RateLow);
+    TEST_ASSERT_EQUAL_UINT16(low, get_schedule(TASK2));
+    TEST_ASSERT_EQUAL_UINT8(1<<PCIE2, PCICR & (1<<PCIE2));
+
+    // A key wakes up the system task, which switches back to the full rate
+    PIND = (1<<KEY2);
+    PCINT2_vect();
+    TEST_ASSERT_EQUAL_UINT8(0, PCICR & (1<<PCIE2));
+    TEST_ASSERT_EQUAL_UINT8(TASK2, next_task());
+    test_RunSYS();
+    TEST_ASSERT_EQUAL_UINT8(0, oScale.RateLow);
+    TEST_ASSERT_EQUAL_UINT16(full, get_schedule(TASK2));
+
+    // A change of the weight also switches back
+    PIND = 0;
+    for (unsigned int run = 0; run <= SYS_IDLE_RUNS + 1; run++)
+        test_RunSYS();
+    TEST_ASSERT_EQUAL_UINT8(1, oScale.RateLow);
+    ValueADC = 0x1000 - 2 * SYS_IDLE_DELTA;
+    test_RunSYS();
+    TEST_ASSERT_EQUAL_UINT8(0, oScale.RateLow);
+    TEST_ASSERT_EQUAL_UINT16(full, get_schedule(TASK2));
+
+    // The running timer keeps the full rate
+    temp_timer_enable = 1;
+    for (unsigned int run = 0; run <= 2 * SYS_IDLE_RUNS; run++)
+        test_RunSYS();
+    TEST_ASSERT_EQUAL_UINT8(0, oScale.RateLow);
+};
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot);
+    RUN_TEST(test_low_rate);
+    return UNITY_END();
+};
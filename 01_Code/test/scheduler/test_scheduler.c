@@ -30,6 +30,9 @@
 #include <unity.h>
 #include <scheduler.h>
 
+// ****** Variables ******
+extern volatile schedule_t os; // The scheduler data
+
 // ****** Functions ******
 
 /**
@@ -48,7 +51,7 @@ void test_init(void)
         TEST_ASSERT_EQUAL_UINT8(0, run(iTask));
     }
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
@@ -69,7 +72,7 @@ void test_set_task(void)
     for( unsigned char iTask = 0; iTask < NUM_TASKS; iTask++)
         TEST_ASSERT_EQUAL_UINT8(ACTIVE, get_task(iTask));
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
@@ -83,11 +86,15 @@ void test_count_task(void)
     scheduler_init(100);
 
     // Schedule one test task
-    schedule(TASK0, 5); // TASK0, every 5 SysTicks
+    TEST_ASSERT_EQUAL_UINT8(1, schedule(TASK0, 5)); // TASK0, every 5 SysTicks
+
+    // A schedule of 0 is rejected, the task keeps its schedule
+    TEST_ASSERT_EQUAL_UINT8(0, schedule(TASK0, 0));
+    TEST_ASSERT_EQUAL_UINT16(5, get_schedule(TASK0));
 
     // Execute task counter
     for(unsigned char iTick = 0; iTick < 5; iTick++)
-        count_task(TASK0);
+        run_scheduler();
     
     // Check task flag
     TEST_ASSERT_EQUAL_UINT8(1, run(TASK0));
@@ -97,12 +104,12 @@ void test_count_task(void)
 
     // Execute task counter longer than scheduled ticks
     for(unsigned char iTick = 0; iTick < 7; iTick++)
-        count_task(TASK0);
+        run_scheduler();
     
     // Check task flag, it should stayed active
     TEST_ASSERT_EQUAL_UINT8(1, run(TASK0));
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
@@ -165,7 +172,7 @@ void test_schedule_tick(void)
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK1));
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK2));
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
@@ -228,7 +235,7 @@ void test_schedule_us(void)
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK1));
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK2));
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
@@ -290,11 +297,327 @@ void test_schedule_ms(void)
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK1));
     TEST_ASSERT_EQUAL_UINT8(0, run(TASK2));
 
-    // Test the overflow flag -> should be 0 since it is not used yet
+    // Test the overflow flag -> should be 0 since no task missed its slot
     TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
 };
 
 // ****** Main ******
+/**
+ * @brief Test the SysTick count for the time stamps.
+ * @details unit test
+ */
+void test_ticks(void)
+{
+    // Initialize scheduler
+    scheduler_init(100);
+    TEST_ASSERT_EQUAL_UINT16(0, get_ticks());
+
+    // Every SysTick increments the count, also without active tasks
+    for(unsigned int iTick = 0; iTick < 300; iTick++)
+        run_scheduler();
+    TEST_ASSERT_EQUAL_UINT16(300, get_ticks());
+
+    // A new initialization restarts the count
+    scheduler_init(100);
+    TEST_ASSERT_EQUAL_UINT16(0, get_ticks());
+};
+
+/**
+ * @brief Test the duty cycle of the active time.
+ * @details unit test
+ */
+void test_duty_cycle(void)
+{
+    // Initialize scheduler
+    scheduler_init(100);
+    TEST_ASSERT_EQUAL_UINT16(0, get_duty_cycle(100));
+
+    // The tasks were active for 10 and 30 of 100 counts
+    count_busy(10);
+    count_busy(30);
+    TEST_ASSERT_EQUAL_UINT16(200, get_duty_cycle(100));
+
+    // The sum is halved when the window is full and follows the new load
+    for(unsigned int iTick = 0; iTick < 4 * DUTY_WINDOW; iTick++)
+        count_busy(100);
+    TEST_ASSERT_UINT16_WITHIN(1, 1000, get_duty_cycle(100));
+    TEST_ASSERT_LESS_OR_EQUAL(DUTY_WINDOW, os.busy_ticks);
+
+    // Reset the measurement
+    reset_duty_cycle();
+    TEST_ASSERT_EQUAL_UINT16(0, get_duty_cycle(100));
+};
+
+/**
+ * @brief Test the detection of a task which missed its slot.
+ * @details unit test
+ */
+void test_overflow(void)
+{
+    // Initialize scheduler
+    scheduler_init(100);
+    schedule(TASK0, 2); // TASK 0, every 2 SysTicks
+
+    // The task runs within its slot
+    run_scheduler();
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(1, run(TASK0));
+    TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
+
+    // The task is still waiting when its next slot starts
+    run_scheduler();
+    run_scheduler();
+    run_scheduler();
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(1, schedule_overflow());
+
+    // Clear the flag
+    clear_overflow();
+    TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
+};
+
+/**
+ * @brief Test the execution time statistics of a task.
+ * @details unit test
+ */
+void test_exec_time(void)
+{
+    volatile unsigned char counter = 0; // Replaces the timer register
+
+    // Initialize scheduler
+    scheduler_init(100);
+    TEST_ASSERT_EQUAL_UINT16(0, get_exec_mean(TASK1));
+
+    // Execution within one SysTick: 30 counts
+    counter = 10;
+    begin_task(TASK1, &counter);
+    counter = 40;
+    end_task(TASK1, &counter);
+
+    // Execution over the next SysTick: 100 - 90 + 30 = 40 counts
+    counter = 90;
+    begin_task(TASK1, &counter);
+    run_scheduler();
+    counter = 30;
+    end_task(TASK1, &counter);
+
+    TEST_ASSERT_EQUAL_UINT16(30, get_exec_min(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(40, get_exec_max(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(35, get_exec_mean(TASK1));
+
+    // The other tasks are not affected
+    TEST_ASSERT_EQUAL_UINT16(0, get_exec_max(TASK0));
+
+    // Reset the statistics
+    reset_exec_time(TASK1);
+    TEST_ASSERT_EQUAL_UINT16(0, get_exec_min(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(0, get_exec_max(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(0, get_exec_mean(TASK1));
+};
+
+/**
+ * @brief Test the delta list against the per task counters it replaces.
+ * @details unit test
+ */
+void test_delta_list(void)
+{
+    const unsigned int period[] = {1, 7, 5, 3};
+    _Static_assert(sizeof(period) / sizeof(period[0]) == NUM_TASKS, "Every task needs a period!");
+    unsigned int timer[NUM_TASKS];
+
+    // Initialize scheduler and the reference counters
+    scheduler_init(100);
+    for( unsigned char iTask = 0; iTask < NUM_TASKS; iTask++)
+    {
+        schedule(iTask, period[iTask]);
+        timer[iTask] = period[iTask] - 1;
+    }
+
+    for(unsigned int iTick = 0; iTick < 1000; iTick++)
+    {
+        // Pause the last task for a while, it restarts with a full period
+        if(iTick == 300)
+            set_task(NUM_TASKS - 1, INACTIVE);
+        if(iTick == 400)
+        {
+            set_task(NUM_TASKS - 1, ACTIVE);
+            timer[NUM_TASKS - 1] = period[NUM_TASKS - 1] - 1;
+        }
+
+        run_scheduler();
+        for( unsigned char iTask = 0; iTask < NUM_TASKS; iTask++)
+        {
+            unsigned char expected = 0;
+            if(get_task(iTask))
+            {
+                if(timer[iTask])
+                    timer[iTask]--;
+                else
+                {
+                    timer[iTask] = period[iTask] - 1;
+                    expected = 1;
+                }
+            }
+            TEST_ASSERT_EQUAL_UINT8(expected, run(iTask));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
+};
+
+/**
+ * @brief Test the dispatch of the waiting tasks by bit scan.
+ * @details unit test
+ */
+void test_next_task(void)
+{
+    // Initialize scheduler, all tasks run every SysTick
+    scheduler_init(100);
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    for( unsigned char iTask = 0; iTask < NUM_TASKS; iTask++)
+        schedule(iTask, 1);
+
+    // The waiting tasks are returned once, the lowest task number first
+    run_scheduler();
+    for( unsigned char iTask = 0; iTask < NUM_TASKS; iTask++)
+        TEST_ASSERT_EQUAL_UINT8(iTask, next_task());
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+
+    // A task which is taken by run() is skipped
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(1, run(TASK0));
+    TEST_ASSERT_EQUAL_UINT8(TASK1, next_task());
+};
+
+/**
+ * @brief Test the tasks which are only started by events.
+ * @details unit test
+ */
+void test_events(void)
+{
+    // Initialize scheduler, TASK0 has no timer and TASK1 runs every 4th SysTick
+    scheduler_init(100);
+    schedule_event(TASK0);
+    schedule(TASK1, 4);
+    TEST_ASSERT_EQUAL_UINT8(ACTIVE, get_task(TASK0));
+
+    // The event task never expires
+    for (unsigned char count = 0; count < 3; count++)
+    {
+        run_scheduler();
+        TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    }
+
+    // An event from a task starts it in the same pass, several events run once
+    post_event(TASK0);
+    post_event(TASK0);
+    TEST_ASSERT_EQUAL_UINT8(TASK0, next_task());
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+
+    // An event from an interrupt
+    post_event_isr(TASK0);
+    post_event_isr(TASK0);
+    TEST_ASSERT_EQUAL_UINT8(1, run(TASK0));
+    TEST_ASSERT_EQUAL_UINT8(0, run(TASK0));
+
+    // A SysTick request starts the task with the next SysTick only
+    post_tick(TASK0);
+    post_tick(TASK0);
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(TASK0, next_task());
+    TEST_ASSERT_EQUAL_UINT8(TASK1, next_task());
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+
+    // A request for a task which is already waiting is no loop overflow
+    for (unsigned char count = 0; count < 3; count++)
+        run_scheduler();
+    post_tick(TASK1);
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(TASK1, next_task());
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    TEST_ASSERT_EQUAL_UINT8(0, schedule_overflow());
+
+    // Events of inactive tasks are ignored, an inactive task discards its events
+    post_event(TASK2);
+    post_event_isr(TASK2);
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+    post_event(TASK0);
+    post_tick(TASK0);
+    set_task(TASK0, INACTIVE);
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(NO_TASK, next_task());
+
+    // The event task can be scheduled periodically again
+    schedule(TASK0, 1);
+    run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(TASK0, next_task());
+};
+
+/**
+ * @brief Count the SysTicks until a task runs.
+ * @param task The number of the task(group).
+ * @return The number of SysTicks.
+ */
+unsigned int test_TicksUntilRun(unsigned char task)
+{
+    unsigned int _ticks = 0;
+    do
+    {
+        run_scheduler();
+        _ticks++;
+    } while (!run(task) && (_ticks < 1000));
+    return _ticks;
+};
+
+/**
+ * @brief Test the change of the schedule while the scheduler is running.
+ * @details unit test
+ */
+void test_reschedule(void)
+{
+    // Initialize scheduler, TASK1 runs every 10th SysTick
+    scheduler_init(100);
+    schedule(TASK0, 3);
+    schedule(TASK1, 10);
+    TEST_ASSERT_EQUAL_UINT16(10, test_TicksUntilRun(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(10, get_schedule(TASK1));
+
+    // A slower schedule extends the running period, the phase is kept
+    for (unsigned char count = 0; count < 4; count++)
+        run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(0, reschedule(TASK1, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, reschedule(TASK1, 50));
+    TEST_ASSERT_EQUAL_UINT8(0, reschedule(TASK1, 20));
+    TEST_ASSERT_EQUAL_UINT16(10, get_schedule(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(46, test_TicksUntilRun(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(50, get_schedule(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(50, test_TicksUntilRun(TASK1));
+
+    // A faster schedule shortens the running period
+    for (unsigned char count = 0; count < 20; count++)
+        run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(1, reschedule(TASK1, 25));
+    TEST_ASSERT_EQUAL_UINT16(5, test_TicksUntilRun(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(25, test_TicksUntilRun(TASK1));
+
+    // The task runs right away when the new period already passed
+    for (unsigned char count = 0; count < 20; count++)
+        run_scheduler();
+    TEST_ASSERT_EQUAL_UINT8(1, reschedule(TASK1, 10));
+    TEST_ASSERT_EQUAL_UINT16(1, test_TicksUntilRun(TASK1));
+    TEST_ASSERT_EQUAL_UINT16(10, test_TicksUntilRun(TASK1));
+
+    // The other task is not moved
+    TEST_ASSERT_EQUAL_UINT16(3, get_schedule(TASK0));
+    while (run(TASK0));
+    test_TicksUntilRun(TASK0);
+    TEST_ASSERT_EQUAL_UINT16(3, test_TicksUntilRun(TASK0));
+    TEST_ASSERT_EQUAL_UINT16(3, test_TicksUntilRun(TASK0));
+    TEST_ASSERT_EQUAL_UINT8(1, schedule_overflow());
+};
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -304,5 +627,13 @@ int main(void)
     RUN_TEST(test_schedule_tick);
     RUN_TEST(test_schedule_us);
     RUN_TEST(test_schedule_ms);
+    RUN_TEST(test_ticks);
+    RUN_TEST(test_duty_cycle);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_exec_time);
+    RUN_TEST(test_delta_list);
+    RUN_TEST(test_next_task);
+    RUN_TEST(test_events);
+    RUN_TEST(test_reschedule);
     UNITY_END();
 };
\ No newline at end of file
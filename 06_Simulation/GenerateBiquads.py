@@ -0,0 +1,225 @@
+#
+# OTP-22 oScale Firmware
+# Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+#
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+### Details
+- *File:*     GenerateBiquads.py
+- *Details:*  Python 3.9
+- *Date:*     2026-10-17
+- *Version:*  v1.0.0
+- *Description*:
+            This script calculates the Q2.14 coefficients of the biquads in
+            *filter8.c* at build time and writes them as BIQUAD_INIT() defines
+            to a header. The firmware can then declare the filters initialized,
+            without the floating point math of the Create functions:
+            `Biquad_t Filter = NOTCH_50HZ;`
+
+            The coefficients are quantized like biquad_Quantize() and checked
+            for an overflow of the accumulator like CreateBiquad(). The
+            Create functions calculate in float, so a coefficient can differ
+            by 1 in rare cases.
+
+            Every filter is given as NAME:TYPE:FS:F0[:Q], F0 in Hz, e.g.:
+            `python GenerateBiquads.py --filter LOWPASS_2HZ:butterworth:100:2
+            --filter NOTCH_50HZ:notch:1000:50:5 --bits 13 --output ../01_Code/include/biquads.h`
+
+### Author
+Sebastian Oberschwendtner, :email: sebastian.oberschwendtner@gmail.com
+"""
+# ****** Modules ******
+import os
+import sys
+import math
+import argparse
+
+# ****** Variables ******
+BIQUAD_Q = 14
+BIQUAD_ONE = 1 << BIQUAD_Q
+
+# Bound of the L1 norm of the impulse response in quarters, like filter8.h
+BIQUAD_GAIN = {'butterworth': 6, 'critical': 6, 'notch': 10}
+
+HEADER = """/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    {name}
+ * @brief   Initializers of biquads with the coefficients in Q2.14.
+ *          Generated by 06_Simulation/GenerateBiquads.py, do not edit!
+ * @details
+ * - Input samples: {bits} bits
+ ******************************************************************************
+ */
+"""
+
+# ****** Functions ******
+
+def Design(Type: str, Fs: float, F0: float, Q: float) -> tuple:
+    """Get the coefficients of a biquad with the bilinear transform, like the Create functions.
+
+    Args:
+        Type (str): 1x1 butterworth, critical or notch.
+        Fs (float): 1x1 [Hz] The sampling frequency.
+        F0 (float): 1x1 [Hz] The corner frequency or the frequency of the notch.
+        Q (float): 1x1 [-] The quality of the notch.
+
+    Returns:
+        tuple: The nominator coefficients b0, b1, b2 and the denominator coefficients a0, a1, a2.
+
+    ---
+    """
+    _w0 = 2 * math.pi * F0 / Fs
+    _cos = math.cos(_w0)
+    if Type == 'notch':
+        if not 0 < F0 < Fs / 2:
+            raise ValueError('The notch frequency has to be below Fs/2')
+        _alpha = math.sin(_w0) / (2 * Q)
+        _b = [1.0, -2.0 * _cos, 1.0]
+    else:
+        if not 0 < F0 <= Fs / 4:
+            raise ValueError('The corner frequency of a low-pass has to be at most Fs/4')
+        _alpha = math.sin(_w0) / (2 * (math.sqrt(0.5) if Type == 'butterworth' else 0.5))
+        _b = [(1 - _cos) / 2, 1 - _cos, (1 - _cos) / 2]
+    return _b, [1 + _alpha, -2.0 * _cos, 1 - _alpha]
+
+def Quantize(b: list, a: list) -> tuple:
+    """Quantize the coefficients to Q2.14 with a gain of exactly 1 at DC, like biquad_Quantize().
+
+    Args:
+        b (list): 1x3 The nominator coefficients.
+        a (list): 1x3 The denominator coefficients.
+
+    Returns:
+        tuple: The quantized b0, b1, b2 and a1, a2.
+
+    ---
+    """
+    _b = [int(math.floor(abs(_value / a[0]) * BIQUAD_ONE + 0.5)) * (1 if _value >= 0 else -1) for _value in b]
+    _a = [int(math.floor(abs(_value / a[0]) * BIQUAD_ONE + 0.5)) * (1 if _value >= 0 else -1) for _value in a[1:]]
+    _b[1] = BIQUAD_ONE + _a[0] + _a[1] - _b[0] - _b[2]
+    if not _b[0]:
+        raise ValueError('The frequency is too low for Q2.14, b0 is 0')
+    for _value in _b + _a:
+        if not -32768 <= _value <= 32767:
+            raise ValueError(f'The coefficient {_value} does not fit into Q2.14')
+    return _b, _a
+
+def Check(b: list, a: list, SampleBits: int, Gain: int):
+    """Check that the accumulator cannot overflow, like CreateBiquad().
+
+    Args:
+        b (list): 1x3 The quantized nominator coefficients.
+        a (list): 1x2 The quantized denominator coefficients.
+        SampleBits (int): 1x1 Bitsize of the magnitude of the signed input samples.
+        Gain (int): 1x1 Bound of the L1 norm of the impulse response in quarters.
+
+    ---
+    """
+    _xmax = 1 << SampleBits
+    _ymax = (_xmax * Gain) >> 2
+    if SampleBits > 15 or _ymax > 0x8000:
+        raise ValueError(f'The output of {SampleBits}-bit samples does not fit into 16 bits')
+    _acc = BIQUAD_ONE + sum(abs(_value) for _value in b) * _xmax + sum(abs(_value) for _value in a) * _ymax
+    if _acc >= 0x80000000:
+        raise ValueError(f'The accumulator can overflow with {SampleBits}-bit samples')
+
+def Generate(Filters: list, SampleBits: int, OutPath: str = None):
+    """Generate the initializers of the biquads and write them to the output header.
+    The header is only written when its content changes.
+
+    Args:
+        Filters (list): nx1 The filters as NAME:TYPE:FS:F0[:Q].
+        SampleBits (int): 1x1 Bitsize of the magnitude of the signed input samples.
+        OutPath (str, optional): 1x1 The path of the generated header, None prints it. Defaults to None.
+
+    ---
+    """
+    _name = os.path.basename(OutPath) if OutPath else 'biquads.h'
+    _guard = _name.upper().replace('.', '_') + '_'
+    Lines = [HEADER.format(name=_name, bits=SampleBits)]
+    Lines.append(f'#ifndef {_guard}')
+    Lines.append(f'#define {_guard}\n')
+    Lines.append('// ****** Includes ******')
+    Lines.append('#include <filter8.h>\n')
+    Lines.append('// ****** Defines ******')
+
+    for _filter in Filters:
+        _fields = _filter.split(':')
+        if len(_fields) not in (4, 5):
+            raise ValueError(f'{_filter}: expected NAME:TYPE:FS:F0[:Q]')
+        _type = _fields[1].lower()
+        if _type not in BIQUAD_GAIN:
+            raise ValueError(f'{_filter}: the type has to be one of {", ".join(BIQUAD_GAIN)}')
+        _fs = float(_fields[2])
+        _f0 = float(_fields[3])
+        _q = float(_fields[4]) if len(_fields) == 5 else 1.0
+
+        _b, _a = Quantize(*Design(_type, _fs, _f0, _q))
+        Check(_b, _a, SampleBits, BIQUAD_GAIN[_type])
+        _values = ', '.join(str(_value) for _value in _b + _a)
+        _q_text = f', Q = {_q:g}' if _type == 'notch' else ''
+        Lines.append(f'// {_type}: Fs = {_fs:g} Hz, F0 = {_f0:g} Hz{_q_text}')
+        Lines.append(f'#define {_fields[0]} BIQUAD_INIT({_values})')
+
+    Lines.append('#endif')
+    Output = '\n'.join(Lines) + '\n'
+
+    if not OutPath:
+        sys.stdout.write(Output)
+        return
+
+    # Only touch the header when the content changed, so the firmware is not rebuilt
+    if os.path.exists(OutPath):
+        with open(OutPath, 'r') as File:
+            if File.read() == Output:
+                return
+    with open(OutPath, 'w') as File:
+        File.write(Output)
+    print(f'Generated {OutPath}: {len(Filters)} biquads')
+
+# ****** Main ******
+if __name__ == "__main__":
+    Parser = argparse.ArgumentParser(description='Generate the initializers of biquads for filter8.')
+    Parser.add_argument('--filter', action='append', required=True,
+        help='Filter as NAME:TYPE:FS:F0[:Q], TYPE is butterworth, critical or notch')
+    Parser.add_argument('--bits', type=int, default=14,
+        help='Bitsize of the magnitude of the signed input samples')
+    Parser.add_argument('--output', default=None,
+        help='Path of the generated header, the header is printed without it')
+    Args = Parser.parse_args()
+    try:
+        Generate(Args.filter, Args.bits, Args.output)
+    except ValueError as Error:
+        sys.exit(f'Error: {Error}')
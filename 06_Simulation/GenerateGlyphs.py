@@ -0,0 +1,244 @@
+#
+# OTP-22 oScale Firmware
+# Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+#
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+### Details
+- *File:*     GenerateGlyphs.py
+- *Details:*  Python 3.9
+- *Date:*     2026-10-17
+- *Version:*  v1.0.0
+- *Description*:
+            This script converts the fonts in *font.h* and *digit.h* to the
+            glyph tables in *glyph.h*. The columns of the glyphs are stored in
+            the order they are sent to the display, one table row per page.
+            The display driver can then stream the glyphs without any index
+            arithmetic. The character font can be reduced to the glyphs which
+            are actually used, to save flash.
+
+            The script can be called from the command line or as an extra
+            script of platformio, then the tables are generated before every build:
+            `extra_scripts = pre:../06_Simulation/GenerateGlyphs.py`
+
+### Author
+Sebastian Oberschwendtner, :email: sebastian.oberschwendtner@gmail.com
+"""
+# ****** Modules ******
+import os
+import re
+import sys
+import argparse
+
+# ****** Variables ******
+# The glyphs of the character font which are used by the firmware:
+# The battery symbols and the printable ASCII characters.
+DEFAULT_GLYPHS = '0x07-0x0B,0x20-0x7E'
+
+# The first character of the digit font
+DIGIT_FIRST = 0x2C
+
+HEADER = """/**
+ * OTP-22 oScale Firmware
+ * Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+/**
+ ******************************************************************************
+ * @file    glyph.h
+ * @brief   Glyph tables of the fonts in the order they are sent to the display.
+ *          Generated by 06_Simulation/GenerateGlyphs.py, do not edit!
+ * @details
+ * - Glyphs: {glyphs}
+ * - glyph_font[index][column]: The columns of a character, index from glyph_font_index.
+ * - glyph_digit[digit][row][column]: The columns of a digit for each page.
+ ******************************************************************************
+ */
+"""
+
+# ****** Functions ******
+
+def ReadTable(Path: str, Name: str) -> list:
+    """Read a font table from a C header file.
+
+    Args:
+        Path (str): 1x1 The path of the header file.
+        Name (str): 1x1 The name of the table in the header file.
+
+    Returns:
+        list: nx1 The rows of the table as lists of bytes.
+
+    ---
+    """
+    with open(Path, 'r') as File:
+        Content = File.read()
+
+    # Get the initializer of the table
+    Start = Content.index(Name + '[')
+    Start = Content.index('=', Start)
+    End = Content.index('};', Start)
+
+    # Get all rows of the table
+    Rows = re.findall(r'\{([^{}]*)\}', Content[Start:End])
+    return [[int(Value, 16) for Value in Row.split(',')] for Row in Rows]
+
+def ParseGlyphs(Spec: str) -> list:
+    """Get the list of glyphs from a specification string.
+
+    Args:
+        Spec (str): 1x1 Comma separated characters or ranges, e.g. '0x07-0x0B,0x20-0x7E'.
+
+    Returns:
+        list: nx1 The sorted character codes.
+
+    ---
+    """
+    Glyphs = set()
+    for Part in Spec.split(','):
+        if '-' in Part:
+            First, Last = Part.split('-')
+            Glyphs.update(range(int(First, 0), int(Last, 0) + 1))
+        else:
+            Glyphs.add(int(Part, 0))
+    return sorted(Glyphs)
+
+def FormatRow(Row: list) -> str:
+    """Format one table row as a C initializer.
+
+    Args:
+        Row (list): nx1 The bytes of the row.
+
+    Returns:
+        str: 1x1 The initializer of the row.
+
+    ---
+    """
+    return '{' + ','.join(f'0x{Value:02X}' for Value in Row) + '}'
+
+def Generate(FontPath: str, DigitPath: str, OutPath: str, Spec: str = DEFAULT_GLYPHS):
+    """Generate the glyph tables and write them to the output header.
+    The header is only written when its content changes.
+
+    Args:
+        FontPath (str): 1x1 The path of *font.h*.
+        DigitPath (str): 1x1 The path of *digit.h*.
+        OutPath (str): 1x1 The path of the generated header.
+        Spec (str, optional): 1x1 The glyphs of the character font to use. Defaults to DEFAULT_GLYPHS.
+
+    ---
+    """
+    Font = ReadTable(FontPath, 'font')
+    Digit = ReadTable(DigitPath, 'number')
+    FontX = len(Font[0])
+    DigitX = len(Digit[0]) // 2
+    Glyphs = [Glyph for Glyph in ParseGlyphs(Spec) if Glyph < len(Font)]
+    First = Glyphs[0]
+    Last = Glyphs[-1]
+
+    # The driver writes the columns of a character from the last to the first one.
+    # Index 0 is a blank glyph for all characters which are not in the subset.
+    Lines = [HEADER.format(glyphs=Spec)]
+    Lines.append('#ifndef GLYPH_H_')
+    Lines.append('#define GLYPH_H_\n')
+    Lines.append('// ****** Defines ******')
+    Lines.append(f'#define FONT_X {FontX}')
+    Lines.append('#define FONT_Y 8')
+    Lines.append(f'#define DIGIT_X {DigitX}')
+    Lines.append('#define DIGIT_Y 16')
+    Lines.append(f'#define GLYPH_FONT_FIRST    0x{First:02X} // The first character in the index table')
+    Lines.append(f'#define GLYPH_FONT_LAST     0x{Last:02X} // The last character in the index table')
+    Lines.append(f'#define GLYPH_FONT_COUNT    {len(Glyphs) + 1} // The number of glyphs in the character table')
+    Lines.append(f'#define GLYPH_DIGIT_FIRST   0x{DIGIT_FIRST:02X} // The first character of the digit table')
+    Lines.append(f'#define GLYPH_DIGIT_COUNT   {len(Digit)} // The number of glyphs in the digit table\n')
+
+    # Index table
+    Index = [0] * (Last - First + 1)
+    for Count, Glyph in enumerate(Glyphs):
+        Index[Glyph - First] = Count + 1
+    Lines.append('// ****** Tables ******')
+    Lines.append('const __flash unsigned char glyph_font_index[GLYPH_FONT_LAST - GLYPH_FONT_FIRST + 1]={')
+    for Start in range(0, len(Index), 16):
+        Lines.append('\t' + ','.join(f'{Value:3d}' for Value in Index[Start:Start + 16]) + ',')
+    Lines[-1] = Lines[-1].rstrip(',')
+    Lines.append('};\n')
+
+    # Character table
+    Rows = [FormatRow([0] * FontX) + ',\t// blank']
+    for Glyph in Glyphs:
+        Rows.append(FormatRow(Font[Glyph][::-1]) + f',\t// 0x{Glyph:02X}')
+    Rows[-1] = Rows[-1].replace(',\t', '\t')
+    Lines.append('const __flash unsigned char glyph_font[GLYPH_FONT_COUNT][FONT_X]={')
+    Lines.extend(Rows)
+    Lines.append('};\n')
+
+    # Digit table, the even bytes belong to the lower page (row 0)
+    Rows = []
+    for Count, Glyph in enumerate(Digit):
+        Pages = [FormatRow(Glyph[2*(DigitX - 1) + Row::-2]) for Row in range(2)]
+        Rows.append('{' + ','.join(Pages) + '},' + f'\t// 0x{DIGIT_FIRST + Count:02X}')
+    Rows[-1] = Rows[-1].replace(',\t', '\t')
+    Lines.append('const __flash unsigned char glyph_digit[GLYPH_DIGIT_COUNT][2][DIGIT_X]={')
+    Lines.extend(Rows)
+    Lines.append('};')
+    Lines.append('#endif')
+    Output = '\n'.join(Lines)
+
+    # Only touch the header when the content changed, so the firmware is not rebuilt
+    if os.path.exists(OutPath):
+        with open(OutPath, 'r') as File:
+            if File.read() == Output:
+                return
+    with open(OutPath, 'w') as File:
+        File.write(Output)
+    print(f'Generated {OutPath}: {len(Glyphs)} characters, {len(Digit)} digits')
+
+# ****** Main ******
+try:
+    # Called as extra script of platformio
+    Import('env')
+    _include = env.subst('$PROJECT_INCLUDE_DIR')
+    _spec = env.GetProjectOption('custom_glyphs', DEFAULT_GLYPHS)
+    Generate(os.path.join(_include, 'font.h'),
+             os.path.join(_include, 'digit.h'),
+             os.path.join(_include, 'glyph.h'),
+             _spec)
+except NameError:
+    if __name__ == "__main__":
+        _include = os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), '..', '01_Code', 'include')
+        Parser = argparse.ArgumentParser(description='Generate the glyph tables of the oScale display.')
+        Parser.add_argument('--glyphs', default=DEFAULT_GLYPHS,
+            help='Characters of the font to include, e.g. "0x07-0x0B,0x20-0x7E"')
+        Parser.add_argument('--include', default=_include,
+            help='The include directory of the firmware')
+        Args = Parser.parse_args()
+        Generate(os.path.join(Args.include, 'font.h'),
+                 os.path.join(Args.include, 'digit.h'),
+                 os.path.join(Args.include, 'glyph.h'),
+                 Args.glyphs)
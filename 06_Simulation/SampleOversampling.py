@@ -0,0 +1,260 @@
+#
+# OTP-22 oScale Firmware
+# Copyright (c) 2020 Sebastian Oberschwendtner, sebastian.oberschwendtner@gmail.com
+#
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+### Details
+- *File:*     SampleOversampling.py
+- *Details:*  Python 3.9
+- *Date:*     2026-10-17
+- *Version:*  v1.0.0
+- *Description*:
+            This script simulates the integer behavior of the oversampling,
+            the decimator and the PT1 filter of the ADC in *adc.c* for all
+            oversampling ratios ADC_OSR which fit into the SysTick.
+            The input is a recording of raw 12-bit samples of a constant
+            weight, taken with every SysTick (5 kHz), one sample per line
+            in a text or csv file. Without a recording the script generates
+            one with a normal distributed noise.
+
+            The resolution is shown as the effective number of bits:
+            ENOB = log2(4096 / (sqrt(12) * sigma)), sigma in 12-bit LSB.
+            An ideal 12-bit quantization without noise has 12 bits.
+
+            Record the samples with the firmware by sending adc_Sample()
+            of every SysTick to the serial port or a logic analyzer, then:
+            `python SampleOversampling.py --recording weight.csv`
+
+### Author
+Sebastian Oberschwendtner, :email: sebastian.oberschwendtner@gmail.com
+"""
+# ****** Modules ******
+import math
+import random
+import argparse
+import matplotlib.pyplot as plt
+
+# ****** Variables ******
+SYSTICK_us = 200        # The SysTick of the firmware
+TASK1_ms = 10           # The period of the filtered samples
+OSR_BITS = 2            # Extra bits of the filtered value, ADC_OSR_BITS
+SAMPLE_TICKS = (TASK1_ms * 1000) // SYSTICK_us
+
+# ****** Classes ******
+class PT1_t():
+    """
+    #### Description
+
+    This class mirrors the PT1 filter of *filter8.c* with its integer arithmetic.
+
+    ### Attributes
+
+    |Name                |Access|Type    |Size |Unit           |Description|
+    |---                 |:---: |:---:   |:---:|:---:          |---        |
+    |**a1**              |`R/W` |*uint32*| 1x1 |[-]            |The scaled denominator coefficient.|
+    |**b0**              |`R/W` |*uint32*| 1x1 |[-]            |The scaled nominator coefficient.|
+    |**y**               |`R/W` |*uint32*| 1x1 |[-]            |The filtered value with the extra bits.|
+    |**shift**           |`R/W` |*uint8* | 1x1 |[-]            |Bitshift of the coefficient scaling.|
+    |**extra**           |`R/W` |*uint8* | 1x1 |[-]            |Extra bits of the calculation.|
+
+    ### Methods
+    ---
+
+    """
+    # ****** Methods ******
+    def __init__(self, Fs: int, Gain: int, T: int, SampleBits: int, ExtraBits: int) -> None:
+        """Calculate the coefficients like CreatePT1().
+
+        Args:
+            Fs (int): [Hz] The sampling frequency.
+            Gain (int): [%] The gain of the filter.
+            T (int): [ms] The time constant of the filter.
+            SampleBits (int): [-] Bitsize of the samples.
+            ExtraBits (int): [-] Additional bits for the calculations.
+        """
+        _scale = 30 - SampleBits
+        self.extra = ExtraBits
+        self.shift = _scale - ExtraBits
+        self.a1 = ((T * Fs) << self.shift) // (1000 + T * Fs)
+        self.b0 = (((Gain * 1000) << _scale) // (1000 + T * Fs)) // 100
+        self.y = 0
+
+    def Apply(self, Sample: int) -> int:
+        """Apply the filter like ApplyPT1().
+
+        Args:
+            Sample (int): The new sample.
+
+        Returns:
+            int: The filtered value.
+        """
+        self.y = ((self.b0 * Sample + self.a1 * self.y) & 0xFFFFFFFF) >> self.shift
+        return self.y >> self.extra
+
+
+# ****** Functions ******
+
+def GenerateRecording(Weight: float = 2047.3, Noise: float = 0.8,
+        Duration: float = 20.0, Seed: int = 1) -> list:
+    """Generate a recording of raw samples of a constant weight.
+
+    Args:
+        Weight (float, optional): 1x1 [LSB] The weight in 12-bit codes. Defaults to 2047.3.
+        Noise (float, optional): 1x1 [LSB] Standard deviation of the noise. Defaults to 0.8.
+        Duration (float, optional): 1x1 [s] The length of the recording. Defaults to 20.0.
+        Seed (int, optional): 1x1 The seed of the noise. Defaults to 1.
+
+    Returns:
+        list: The raw samples with the rate of the SysTick.
+
+    ---
+    """
+    _random = random.Random(Seed)
+    _count = int(Duration * 1e6 / SYSTICK_us)
+    return [min(4095, max(0, round(_random.gauss(Weight, Noise)))) for i in range(_count)]
+
+def ReadRecording(Path: str) -> list:
+    """Read a recording of raw samples, the first number of every line is used.
+
+    Args:
+        Path (str): The path of the recording.
+
+    Returns:
+        list: The raw samples with the rate of the SysTick.
+
+    ---
+    """
+    _samples = []
+    with open(Path, 'r') as _file:
+        for _line in _file:
+            _field = _line.replace(';', ',').split(',')[0].strip()
+            if _field.isdigit():
+                _samples.append(int(_field))
+    return _samples
+
+def SimulateADC(Samples: list, OSR: int) -> tuple:
+    """Simulate the decimator and the PT1 of adc.c for one oversampling ratio.
+
+    Args:
+        Samples (list): The raw samples with the rate of the SysTick.
+        OSR (int): The oversampling ratio, has to divide SAMPLE_TICKS.
+
+    Returns:
+        tuple: The decimated samples and the filtered values, both in 12-bit LSB.
+
+    ---
+    """
+    # The decimator like CreateDecimator()
+    _shift = 0
+    while ((4095 * OSR) >> _shift) > 0xFFFF:
+        _shift += 1
+    _gain = (100 << (OSR_BITS + _shift)) // OSR
+    _filter = PT1_t(1000 // TASK1_ms, _gain, 300, 12 + OSR_BITS, 4 - OSR_BITS)
+
+    _decimated = []
+    _filtered = []
+    _step = SAMPLE_TICKS // OSR
+    _sum = 0
+    for _count, _sample in enumerate(Samples[::_step]):
+        _sum += _sample
+        if (_count + 1) % OSR:
+            continue
+        _value = _sum >> _shift
+        _sum = 0
+        _decimated.append(_value * (1 << _shift) / OSR)
+        _filtered.append(_filter.Apply(_value) / (1 << OSR_BITS))
+    return _decimated, _filtered
+
+def GetENOB(Values: list) -> tuple:
+    """Get the noise and the effective number of bits of settled values.
+
+    Args:
+        Values (list): The values in 12-bit LSB.
+
+    Returns:
+        tuple: The standard deviation in LSB and the effective number of bits.
+
+    ---
+    """
+    _mean = sum(Values) / len(Values)
+    _sigma = math.sqrt(sum((_value - _mean)**2 for _value in Values) / len(Values))
+    # The resolution of the value limits the ENOB when the noise is gone
+    _sigma = max(_sigma, 1 / (math.sqrt(12) * (1 << OSR_BITS)))
+    return _sigma, math.log2(4096 / (math.sqrt(12) * _sigma))
+
+def CompareOversampling(Samples: list):
+    """Compare the noise and the resolution of all oversampling ratios.
+
+    Args:
+        Samples (list): The raw samples with the rate of the SysTick.
+
+    ---
+    """
+    Ratios = [_osr for _osr in range(1, SAMPLE_TICKS + 1) if not SAMPLE_TICKS % _osr]
+    Bits_Decimated = []
+    Bits_Filtered = []
+    Responses = []
+
+    print(f'{"ADC_OSR":>8} {"Rate":>8} {"sigma dec":>10} {"ENOB dec":>9} {"sigma PT1":>10} {"ENOB PT1":>9}')
+    for _osr in Ratios:
+        _decimated, _filtered = SimulateADC(Samples, _osr)
+        # Skip the settling of the PT1: 10 time constants
+        _settled = _filtered[300:]
+        _sigma_dec, _bits_dec = GetENOB(_decimated)
+        _sigma_pt1, _bits_pt1 = GetENOB(_settled)
+        Bits_Decimated.append(_bits_dec)
+        Bits_Filtered.append(_bits_pt1)
+        Responses.append(_filtered)
+        print(f'{_osr:>8} {_osr * 1000 // TASK1_ms:>6}Hz {_sigma_dec:>10.3f} {_bits_dec:>9.2f} {_sigma_pt1:>10.3f} {_bits_pt1:>9.2f}')
+
+    # Plot results
+    plt.figure()
+    plt.rcParams.update({'font.size': 22})
+    plt.title('Effective resolution of the ADC')
+    plt.plot(Ratios, Bits_Decimated, '-o', label='Decimated')
+    plt.plot(Ratios, Bits_Filtered, '-o', label='Decimated + PT1')
+    plt.xscale('log')
+    plt.legend()
+    plt.grid(True)
+    plt.xlabel('Oversampling ratio ADC_OSR')
+    plt.ylabel('Effective number of bits')
+
+    plt.figure()
+    plt.title('Filtered value')
+    _time = [_sample * TASK1_ms / 1000 for _sample in range(len(Responses[0]))]
+    for i, _osr in enumerate(Ratios):
+        plt.plot(_time, Responses[i], label=f'ADC_OSR = {_osr}')
+    plt.legend()
+    plt.grid(True)
+    plt.xlabel('Time in $[s]$')
+    plt.ylabel('Filtered value in $[LSB]$')
+    plt.show()
+
+# ****** Main ******
+if __name__ == "__main__":
+    Parser = argparse.ArgumentParser(description='Simulate the oversampling of the oScale ADC.')
+    Parser.add_argument('--recording', default=None,
+        help='File with raw 12-bit samples of every SysTick, one per line')
+    Parser.add_argument('--noise', type=float, default=0.8,
+        help='Noise of the generated recording in LSB')
+    Args = Parser.parse_args()
+
+    if Args.recording:
+        Samples = ReadRecording(Args.recording)
+    else:
+        Samples = GenerateRecording(Noise=Args.noise)
+    CompareOversampling(Samples)